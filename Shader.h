@@ -6,6 +6,7 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
@@ -14,26 +15,14 @@ class Shader
 public:
     unsigned int ID;
     Shader(const char* vertexPath, const char* fragmentPath)
+        : Shader(vertexPath, fragmentPath, std::vector<std::string>()) {}
+
+    // Variant: each name in defines becomes "#define NAME" right after #version;
+    // #include "file" lines are resolved relative to the including file
+    Shader(const char* vertexPath, const char* fragmentPath, const std::vector<std::string> &defines)
     {
-        std::string vertexCode;
-        std::string fragmentCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-        vShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        try 
-        {
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();		
-            vShaderFile.close();
-            fShaderFile.close();
-            vertexCode   = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
-        }
-        catch (std::ifstream::failure& e) { std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ" << std::endl; }
+        std::string vertexCode = loadSource(vertexPath, defines);
+        std::string fragmentCode = loadSource(fragmentPath, defines);
         const char* vShaderCode = vertexCode.c_str();
         const char * fShaderCode = fragmentCode.c_str();
         unsigned int vertex, fragment;
@@ -57,10 +46,68 @@ public:
     void setBool(const std::string &name, bool value) const { glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); }
     void setInt(const std::string &name, int value) const { glUniform1i(glGetUniformLocation(ID, name.c_str()), value); }
     void setFloat(const std::string &name, float value) const { glUniform1f(glGetUniformLocation(ID, name.c_str()), value); }
+    void setVec2(const std::string &name, const glm::vec2 &value) const { glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); }
     void setMat4(const std::string &name, const glm::mat4 &mat) const { glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]); }
     void setVec3(const std::string &name, const glm::vec3 &value) const { glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); }
     void setVec3(const std::string &name, float x, float y, float z) const { glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z); }
 private:
+    static std::string readFile(const std::string &path)
+    {
+        std::ifstream file;
+        file.exceptions (std::ifstream::failbit | std::ifstream::badbit);
+        try 
+        {
+            file.open(path);
+            std::stringstream stream;
+            stream << file.rdbuf();
+            file.close();
+            return stream.str();
+        }
+        catch (std::ifstream::failure& e) { std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << path << std::endl; }
+        return std::string();
+    }
+
+    // Expand #include "file" (relative to path, nested up to a few levels)
+    static std::string expandIncludes(const std::string &path, int depth)
+    {
+        std::string directory = path.substr(0, path.find_last_of("/\\") + 1);
+        std::istringstream source(readFile(path));
+        std::string line, result;
+        while (std::getline(source, line))
+        {
+            size_t start = line.find_first_not_of(" \t");
+            if (start != std::string::npos && line.compare(start, 8, "#include") == 0)
+            {
+                size_t open = line.find('"', start);
+                size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+                if (close == std::string::npos || depth > 8)
+                {
+                    std::cout << "ERROR::SHADER::BAD_INCLUDE: " << path << ": " << line << std::endl;
+                    continue;
+                }
+                result += expandIncludes(directory + line.substr(open + 1, close - open - 1), depth + 1);
+                continue;
+            }
+            result += line + "\n";
+        }
+        return result;
+    }
+
+    static std::string loadSource(const std::string &path, const std::vector<std::string> &defines)
+    {
+        std::string code = expandIncludes(path, 0);
+        if (defines.empty())
+            return code;
+
+        // Defines must follow #version, which has to stay the first line
+        std::string block;
+        for (const std::string &define : defines)
+            block += "#define " + define + "\n";
+        size_t version = code.find("#version");
+        size_t insertAt = version == std::string::npos ? 0 : code.find('\n', version) + 1;
+        return code.insert(insertAt, block);
+    }
+
     void checkCompileErrors(unsigned int shader, std::string type)
     {
         int success;
@@ -0,0 +1,136 @@
+#include "AnimationSystem.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <cmath>
+#include <cstdlib>
+
+AnimationSystem::AnimationSystem()
+{
+    guardModel = new Guard();
+}
+
+AnimationSystem::~AnimationSystem()
+{
+    delete guardModel;
+}
+
+void AnimationSystem::addGuard(glm::vec3 pos, float rotY)
+{
+    guardPosition.push_back(pos);
+    guardRotation.push_back(rotY);
+    guardTime.push_back(0.0f);
+    prevGuardTime.push_back(0.0f);
+
+    guardTransforms.resize(guardTime.size() * Guard::PART_COUNT, glm::mat4(1.0f));
+}
+
+void AnimationSystem::addCloud(glm::vec3 startPos, float speed, float scale)
+{
+    cloudX.push_back(startPos.x);
+    cloudY.push_back(startPos.y);
+    cloudZ.push_back(startPos.z);
+    cloudAltitude.push_back(startPos.y);
+    cloudDriftSpeed.push_back(speed);
+
+    // Random rotation and movement parameters
+    cloudRotation.push_back(static_cast<float>(rand()) / RAND_MAX * 360.0f);
+    cloudRotationSpeed.push_back(2.0f + (rand() % 5)); // 2-6 degrees per second
+
+    // No previous step yet: interpolation starts at the spawn state
+    prevCloudX.push_back(cloudX.back());
+    prevCloudY.push_back(cloudY.back());
+    prevCloudRotation.push_back(cloudRotation.back());
+
+    // Bobbing parameters (vertical oscillation)
+    cloudBobAmplitude.push_back(2.0f + (rand() % 3));                          // 2-4 units
+    cloudBobFrequency.push_back(0.3f + (rand() % 10) / 20.0f);                 // 0.3-0.8 Hz
+    cloudBobPhase.push_back(static_cast<float>(rand()) / RAND_MAX * 6.28f);    // Random starting phase
+
+    // 4-6 ellipsoids arranged in a line to form a wispy streak (cirrus style)
+    int numSpheres = 4 + (rand() % 3);
+    cloudFirstSphere.push_back(static_cast<int>(sphereLocal.size()));
+    cloudSphereCount.push_back(numSpheres);
+
+    for (int i = 0; i < numSpheres; i++)
+    {
+        float offsetX = ((float)i / numSpheres - 0.5f) * 2.0f;    // Spread along X: -1 to 1
+        float offsetY = ((rand() % 100) / 500.0f - 0.1f) * 0.3f;  // Small Y variation
+        float offsetZ = ((rand() % 100) / 500.0f - 0.1f) * 0.2f;  // Small Z variation
+        float sphereScale = 0.6f + (rand() % 40) / 100.0f;        // 0.6 to 1.0
+
+        // Offset and stretch never change, so bake them once
+        float finalScale = scale * sphereScale;
+        glm::mat4 local = glm::translate(glm::mat4(1.0f), glm::vec3(offsetX, offsetY, offsetZ) * scale);
+        local = glm::scale(local, glm::vec3(finalScale * 3.5f, finalScale * 0.3f, finalScale * 1.2f));
+        sphereLocal.push_back(local);
+    }
+
+    cloudTransforms.resize(sphereLocal.size(), glm::mat4(1.0f));
+}
+
+void AnimationSystem::update(float deltaTime)
+{
+    prevGuardTime = guardTime;
+    prevCloudX = cloudX;
+    prevCloudY = cloudY;
+    prevCloudRotation = cloudRotation;
+
+    for (size_t i = 0; i < guardTime.size(); i++)
+        guardTime[i] += deltaTime;
+
+    updateClouds(deltaTime);
+}
+
+void AnimationSystem::updateClouds(float deltaTime)
+{
+    const size_t count = cloudX.size();
+
+    for (size_t i = 0; i < count; i++)
+    {
+        // Horizontal drift, wrapped for horizon coverage
+        float x = cloudX[i] + cloudDriftSpeed[i] * deltaTime;
+        cloudX[i] = x > 2000.0f ? -2000.0f : (x < -2000.0f ? 2000.0f : x);
+
+        // Vertical bobbing (sine wave)
+        cloudBobPhase[i] += cloudBobFrequency[i] * deltaTime;
+        cloudY[i] = cloudAltitude[i] + std::sin(cloudBobPhase[i]) * cloudBobAmplitude[i];
+
+        // Slow rotation
+        float rotation = cloudRotation[i] + cloudRotationSpeed[i] * deltaTime;
+        cloudRotation[i] = rotation > 360.0f ? rotation - 360.0f : rotation;
+    }
+}
+
+void AnimationSystem::writeTransforms(float alpha)
+{
+    for (size_t i = 0; i < guardTime.size(); i++)
+    {
+        float time = prevGuardTime[i] + (guardTime[i] - prevGuardTime[i]) * alpha;
+        Guard::writePartTransforms(guardPosition[i], guardRotation[i], time, &guardTransforms[i * Guard::PART_COUNT]);
+    }
+
+    // Clouds: one root matrix per cloud, times the baked per-sphere matrix
+    for (size_t i = 0; i < cloudX.size(); i++)
+    {
+        // Blend across the step, except where the drift or rotation wrapped
+        float x = cloudX[i];
+        if (std::fabs(x - prevCloudX[i]) < 100.0f)
+            x = prevCloudX[i] + (x - prevCloudX[i]) * alpha;
+        float y = prevCloudY[i] + (cloudY[i] - prevCloudY[i]) * alpha;
+        float rotation = cloudRotation[i];
+        if (rotation >= prevCloudRotation[i])
+            rotation = prevCloudRotation[i] + (rotation - prevCloudRotation[i]) * alpha;
+
+        float angle = glm::radians(rotation);
+        float c = std::cos(angle);
+        float s = std::sin(angle);
+
+        glm::mat4 root(glm::vec4(c, 0.0f, -s, 0.0f),
+                       glm::vec4(0.0f, 1.0f, 0.0f, 0.0f),
+                       glm::vec4(s, 0.0f, c, 0.0f),
+                       glm::vec4(x, y, cloudZ[i], 1.0f));
+
+        int first = cloudFirstSphere[i];
+        for (int k = 0; k < cloudSphereCount[i]; k++)
+            cloudTransforms[first + k] = root * sphereLocal[first + k];
+    }
+}
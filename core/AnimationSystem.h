@@ -0,0 +1,68 @@
+#ifndef ANIMATIONSYSTEM_H
+#define ANIMATIONSYSTEM_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include "Guard.h"
+
+/**
+ * Data-oriented animation for guards and clouds (pigeons live in Flock)
+ * Per-instance state is stored as struct-of-arrays and advanced in tight
+ * loops. writeTransforms() fills the part matrices once per frame; the shadow
+ * pass and the lighting pass both read the same buffers.
+ */
+class AnimationSystem
+{
+public:
+    AnimationSystem();
+    ~AnimationSystem();
+
+    // Spawning
+    void addGuard(glm::vec3 pos, float rotY = 0.0f);
+    void addCloud(glm::vec3 startPos, float speed, float scale);
+
+    // Simulation step, then transform generation (once per frame), blended
+    // from the previous to the current step by alpha
+    void update(float deltaTime);
+    void writeTransforms(float alpha = 1.0f);
+
+    // Shared meshes (one copy for all instances)
+    Guard *guardModel;
+
+    // Transform buffers
+    size_t getGuardCount() const { return guardTime.size(); }
+    size_t getCloudCount() const { return cloudX.size(); }
+    const glm::mat4 *getGuardTransforms(size_t guard) const { return &guardTransforms[guard * Guard::PART_COUNT]; }
+    const std::vector<glm::mat4> &getAllGuardTransforms() const { return guardTransforms; }
+    const std::vector<glm::mat4> &getCloudTransforms() const { return cloudTransforms; } // One per cloud ellipsoid
+    int getCloudFirstSphere(size_t cloud) const { return cloudFirstSphere[cloud]; }
+    int getCloudSphereCount(size_t cloud) const { return cloudSphereCount[cloud]; }
+    const std::vector<glm::mat4> &getCloudLocalTransforms() const { return sphereLocal; } // Ellipsoids in their cloud's frame
+
+private:
+    void updateClouds(float deltaTime);
+
+    // ===== Guards (breathing only) =====
+    std::vector<glm::vec3> guardPosition;
+    std::vector<float> guardRotation;
+    std::vector<float> guardTime;
+    std::vector<float> prevGuardTime;
+    std::vector<glm::mat4> guardTransforms; // Guard::PART_COUNT per guard
+
+    // ===== Clouds (drift, bobbing, slow rotation) =====
+    std::vector<float> cloudX, cloudY, cloudZ;
+    std::vector<float> prevCloudX, prevCloudY, prevCloudRotation; // Before the last step
+    std::vector<float> cloudAltitude;
+    std::vector<float> cloudDriftSpeed;
+    std::vector<float> cloudBobAmplitude;
+    std::vector<float> cloudBobFrequency;
+    std::vector<float> cloudBobPhase;
+    std::vector<float> cloudRotation;      // Degrees around Y
+    std::vector<float> cloudRotationSpeed;
+    std::vector<int> cloudFirstSphere;     // Range into the sphere arrays
+    std::vector<int> cloudSphereCount;
+    std::vector<glm::mat4> sphereLocal;    // Static offset + ellipsoid stretch
+    std::vector<glm::mat4> cloudTransforms;
+};
+
+#endif
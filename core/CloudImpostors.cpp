@@ -0,0 +1,291 @@
+#include "CloudImpostors.h"
+#include "AnimationSystem.h"
+#include "Mesh.h"
+#include "../models/Texture.h"
+#include "../Shader.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace
+{
+    // Sort keys: view depth quantised to 16 bits over this range
+    const float MAX_SORT_DEPTH = 4000.0f;
+
+    // Impostors are baked as seen from this far below the cloud's level: they
+    // start at 700 m and clouds fly at 200-350 m, so far clouds are seen
+    // side-on, about 7-21 degrees up
+    const float BAKE_ELEVATION_DEGREES = 15.0f;
+
+    // Half extent of an ellipsoid (columns of m scaled the unit sphere) along u
+    float support(const glm::mat4 &m, glm::vec3 u)
+    {
+        float x = glm::dot(glm::vec3(m[0]), u);
+        float y = glm::dot(glm::vec3(m[1]), u);
+        float z = glm::dot(glm::vec3(m[2]), u);
+        return std::sqrt(x * x + y * y + z * z);
+    }
+
+    // Billboard right axis: the streak axis with its component towards the
+    // camera removed (the other horizontal axis when looking straight along it)
+    glm::vec3 rightAxis(const glm::mat4 &m, glm::vec3 toCamera)
+    {
+        glm::vec3 axis = glm::vec3(m[0]);
+        glm::vec3 right = axis - toCamera * glm::dot(axis, toCamera);
+        if (glm::dot(right, right) < 1e-4f * glm::dot(axis, axis))
+        {
+            axis = glm::vec3(m[2]);
+            right = axis - toCamera * glm::dot(axis, toCamera);
+        }
+        return glm::normalize(right);
+    }
+
+    // LSD radix sort of (key << 32 | index) on the 16-bit key, two 8-bit passes
+    void radixSort(std::vector<uint64_t> &items)
+    {
+        std::vector<uint64_t> scratch(items.size());
+        for (int shift = 32; shift < 48; shift += 8)
+        {
+            size_t offsets[257] = {0};
+            for (uint64_t item : items)
+                offsets[((item >> shift) & 0xFF) + 1]++;
+            for (int i = 0; i < 256; i++)
+                offsets[i + 1] += offsets[i];
+            for (uint64_t item : items)
+                scratch[offsets[(item >> shift) & 0xFF]++] = item;
+            items.swap(scratch);
+        }
+    }
+
+    // Bilinear luminance of the puff image at uv in [0, 1]
+    float samplePuff(const unsigned char *puff, int size, float u, float v)
+    {
+        if (u <= 0.0f || u >= 1.0f || v <= 0.0f || v >= 1.0f)
+            return 0.0f;
+        float x = u * (size - 1), y = v * (size - 1);
+        int x0 = (int)x, y0 = (int)y;
+        int x1 = std::min(x0 + 1, size - 1), y1 = std::min(y0 + 1, size - 1);
+        float fx = x - x0, fy = y - y0;
+        float a = puff[(y0 * size + x0) * 3] + (puff[(y0 * size + x1) * 3] - puff[(y0 * size + x0) * 3]) * fx;
+        float b = puff[(y1 * size + x0) * 3] + (puff[(y1 * size + x1) * 3] - puff[(y1 * size + x0) * 3]) * fx;
+        return (a + (b - a) * fy) / 255.0f;
+    }
+}
+
+int CloudImpostors::atlasRows(size_t cloudCount)
+{
+    return std::max(1, (int)((cloudCount + ATLAS_COLUMNS - 1) / ATLAS_COLUMNS));
+}
+
+CloudImpostors::CloudImpostors(float impostorDist, float softDist)
+    : impostorDistance(impostorDist), softDistance(softDist),
+      atlas(nullptr), quad(nullptr), instanceBuffer(0), uploadedCount(0)
+{
+}
+
+CloudImpostors::~CloudImpostors()
+{
+    delete atlas;
+    delete quad;
+    if (instanceBuffer != 0)
+        glDeleteBuffers(1, &instanceBuffer);
+}
+
+void CloudImpostors::build(const AnimationSystem &animation, const glm::mat4 &view, glm::vec3 viewPos,
+                           std::vector<Sprite> &out) const
+{
+    const std::vector<glm::mat4> &spheres = animation.getCloudTransforms();
+    const int rows = atlasRows(animation.getCloudCount());
+
+    out.clear();
+    for (size_t cloud = 0; cloud < animation.getCloudCount(); cloud++)
+    {
+        int first = animation.getCloudFirstSphere(cloud);
+        int count = animation.getCloudSphereCount(cloud);
+
+        glm::vec3 center(0.0f);
+        for (int k = 0; k < count; k++)
+            center += glm::vec3(spheres[first + k][3]);
+        center /= (float)count;
+
+        if (glm::length(center - viewPos) < impostorDistance)
+        {
+            // Near: one soft particle per ellipsoid, textured with the whole puff
+            for (int k = 0; k < count; k++)
+            {
+                const glm::mat4 &m = spheres[first + k];
+                glm::vec3 position = glm::vec3(m[3]);
+                glm::vec3 toCamera = glm::normalize(viewPos - position);
+                glm::vec3 right = rightAxis(m, toCamera);
+                glm::vec3 up = glm::cross(toCamera, right);
+
+                Sprite sprite;
+                sprite.centerHalfWidth = glm::vec4(position, support(m, right));
+                sprite.rightHalfHeight = glm::vec4(right, support(m, up));
+                sprite.tile = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+                sprite.params = glm::vec4(0.0f);
+                out.push_back(sprite);
+            }
+            continue;
+        }
+
+        // Far: one impostor covering every ellipsoid of the cloud
+        glm::vec3 toCamera = glm::normalize(viewPos - center);
+        glm::vec3 right = rightAxis(spheres[first], toCamera);
+        glm::vec3 up = glm::cross(toCamera, right);
+
+        float halfWidth = 0.0f, halfHeight = 0.0f;
+        for (int k = 0; k < count; k++)
+        {
+            const glm::mat4 &m = spheres[first + k];
+            glm::vec3 offset = glm::vec3(m[3]) - center;
+            halfWidth = std::max(halfWidth, std::fabs(glm::dot(offset, right)) + support(m, right));
+            halfHeight = std::max(halfHeight, std::fabs(glm::dot(offset, up)) + support(m, up));
+        }
+
+        int tile = (int)cloud;
+        Sprite sprite;
+        sprite.centerHalfWidth = glm::vec4(center, halfWidth);
+        sprite.rightHalfHeight = glm::vec4(right, halfHeight);
+        sprite.tile = glm::vec4((float)(tile % ATLAS_COLUMNS) / ATLAS_COLUMNS, (float)(tile / ATLAS_COLUMNS) / rows,
+                                1.0f / ATLAS_COLUMNS, 1.0f / rows);
+        sprite.params = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+        out.push_back(sprite);
+    }
+
+    // Back to front: larger view depth gets the smaller key
+    std::vector<uint64_t> order(out.size());
+    for (size_t i = 0; i < out.size(); i++)
+    {
+        float depth = -(view * glm::vec4(glm::vec3(out[i].centerHalfWidth), 1.0f)).z;
+        float quantised = glm::clamp(depth / MAX_SORT_DEPTH, 0.0f, 1.0f) * 65535.0f;
+        uint64_t key = 65535u - (unsigned int)quantised;
+        order[i] = (key << 32) | (uint64_t)i;
+    }
+    radixSort(order);
+
+    std::vector<Sprite> sorted(out.size());
+    for (size_t i = 0; i < order.size(); i++)
+        sorted[i] = out[(size_t)(order[i] & 0xFFFFFFFFu)];
+    out.swap(sorted);
+}
+
+void CloudImpostors::initRendering(const AnimationSystem &animation, const unsigned char *puff, int puffSize)
+{
+    // ===== BAKE IMPOSTOR ATLAS =====
+    const int width = ATLAS_COLUMNS * TILE_SIZE, height = atlasRows(animation.getCloudCount()) * TILE_SIZE;
+    unsigned char *data = new unsigned char[width * height * 3];
+    bakeAtlas(animation, puff, puffSize, data);
+    atlas = new Texture(width, height, data, GL_RGB);
+    delete[] data;
+
+    // ===== BILLBOARD QUAD + INSTANCE BUFFER =====
+    std::vector<Vertex> vertices(4);
+    const float corners[4][2] = {{-1.0f, -1.0f}, {1.0f, -1.0f}, {1.0f, 1.0f}, {-1.0f, 1.0f}};
+    for (int i = 0; i < 4; i++)
+    {
+        vertices[i].Position = glm::vec3(corners[i][0], corners[i][1], 0.0f);
+        vertices[i].Normal = glm::vec3(0.0f, 0.0f, 1.0f);
+        vertices[i].TexCoords = glm::vec2(corners[i][0] * 0.5f + 0.5f, corners[i][1] * 0.5f + 0.5f);
+    }
+    quad = new Mesh(vertices, {0, 1, 2, 0, 2, 3});
+
+    glGenBuffers(1, &instanceBuffer);
+    quad->setInstanceAttributes(instanceBuffer, 3, 4, sizeof(Sprite));
+}
+
+void CloudImpostors::bakeAtlas(const AnimationSystem &animation, const unsigned char *puff, int puffSize,
+                               unsigned char *data)
+{
+    // Tile n is cloud n: its ellipsoids (AnimationSystem::addCloud) seen
+    // across the streak from BAKE_ELEVATION_DEGREES below, projected on the
+    // right/up basis build() gives the billboard and fitted to the tile the
+    // way build() sizes it, so the switch from particles does not pop
+    const size_t cloudCount = animation.getCloudCount();
+    const int width = ATLAS_COLUMNS * TILE_SIZE, height = atlasRows(cloudCount) * TILE_SIZE;
+    std::fill(data, data + (size_t)width * height * 3, (unsigned char)0); // Unused tiles stay clear
+    const std::vector<glm::mat4> &local = animation.getCloudLocalTransforms();
+    std::vector<glm::vec4> puffs; // Centre x, y and radius x, y in tile space (-1..1)
+
+    const float elevation = glm::radians(BAKE_ELEVATION_DEGREES);
+    const glm::vec3 toCamera(0.0f, -std::sin(elevation), std::cos(elevation));
+    const glm::vec3 right(1.0f, 0.0f, 0.0f); // The streak axis, already across the view
+    const glm::vec3 up = glm::cross(toCamera, right);
+
+    for (size_t cloud = 0; cloud < cloudCount; cloud++)
+    {
+        int first = animation.getCloudFirstSphere(cloud);
+        int count = animation.getCloudSphereCount(cloud);
+
+        glm::vec3 center(0.0f);
+        for (int k = 0; k < count; k++)
+            center += glm::vec3(local[first + k][3]);
+        center /= (float)count;
+
+        puffs.resize(count);
+        glm::vec2 extent(0.0f);
+        for (int k = 0; k < count; k++)
+        {
+            const glm::mat4 &m = local[first + k];
+            glm::vec3 offset = glm::vec3(m[3]) - center;
+            puffs[k] = glm::vec4(glm::dot(offset, right), glm::dot(offset, up), support(m, right), support(m, up));
+            extent = glm::max(extent, glm::vec2(std::fabs(puffs[k].x) + puffs[k].z, std::fabs(puffs[k].y) + puffs[k].w));
+        }
+        for (int k = 0; k < count; k++)
+            puffs[k] /= glm::vec4(extent.x, extent.y, extent.x, extent.y);
+
+        int tile = (int)cloud;
+        int tileX = (tile % ATLAS_COLUMNS) * TILE_SIZE, tileY = (tile / ATLAS_COLUMNS) * TILE_SIZE;
+        for (int y = 0; y < TILE_SIZE; y++)
+        {
+            for (int x = 0; x < TILE_SIZE; x++)
+            {
+                float px = (x + 0.5f) / TILE_SIZE * 2.0f - 1.0f;
+                float py = (y + 0.5f) / TILE_SIZE * 2.0f - 1.0f;
+
+                // Accumulate coverage like alpha blending the puffs over each other
+                float transmittance = 1.0f;
+                for (int k = 0; k < count; k++)
+                {
+                    float u = ((px - puffs[k].x) / puffs[k].z) * 0.5f + 0.5f;
+                    float v = ((py - puffs[k].y) / puffs[k].w) * 0.5f + 0.5f;
+                    if (k % 2 == 1)
+                        u = 1.0f - u; // Mirror every other puff so neighbours differ
+                    transmittance *= 1.0f - samplePuff(puff, puffSize, u, v);
+                }
+
+                unsigned char value = (unsigned char)(glm::clamp(1.0f - transmittance, 0.0f, 1.0f) * 255);
+                int idx = ((tileY + y) * width + tileX + x) * 3;
+                data[idx] = data[idx + 1] = data[idx + 2] = value;
+            }
+        }
+    }
+}
+
+GLuint CloudImpostors::getAtlasTexture() const
+{
+    return atlas ? atlas->ID : 0;
+}
+
+void CloudImpostors::upload(const std::vector<Sprite> &sprites)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    // Orphan the previous storage so the driver does not stall on in-flight draws
+    glBufferData(GL_ARRAY_BUFFER, sprites.size() * sizeof(Sprite), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, sprites.size() * sizeof(Sprite), sprites.data());
+    uploadedCount = static_cast<GLsizei>(sprites.size());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void CloudImpostors::draw(Shader &shader, Texture *puffTexture, int firstUnit) const
+{
+    if (uploadedCount == 0)
+        return;
+
+    puffTexture->bind(firstUnit);
+    atlas->bind(firstUnit + 1);
+    shader.setInt("cloudTexture", firstUnit);
+    shader.setInt("impostorAtlas", firstUnit + 1);
+    shader.setFloat("softDistance", softDistance);
+    quad->drawInstanced(uploadedCount);
+}
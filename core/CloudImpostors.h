@@ -0,0 +1,75 @@
+#ifndef CLOUDIMPOSTORS_H
+#define CLOUDIMPOSTORS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+class AnimationSystem;
+class Mesh;
+class Shader;
+class Texture;
+
+/**
+ * Clouds as depth-sorted camera-facing sprites (the transparent pass)
+ * build() (CPU, no GL, safe to run as a job) turns every cloud further than
+ * impostorDistance into a single billboard showing its pre-baked impostor
+ * from the atlas, and each nearer cloud into one soft particle per
+ * ellipsoid. Sprites are radix-sorted back to front on quantised view
+ * depth, so the render thread blends them correctly in one instanced draw.
+ */
+class CloudImpostors
+{
+public:
+    // Impostor atlas layout: one tile per cloud, rows added as needed
+    static const int ATLAS_COLUMNS = 8;
+    static const int TILE_SIZE = 128;
+    static int atlasRows(size_t cloudCount);
+
+    // Per-instance data (locations 3-6 in cloud.vs)
+    struct Sprite
+    {
+        glm::vec4 centerHalfWidth; // xyz = world centre, w = half width along right
+        glm::vec4 rightHalfHeight; // xyz = unit right axis, w = half height
+        glm::vec4 tile;            // xy = uv offset, zw = uv scale
+        glm::vec4 params;          // x = 1 for atlas impostors, 0 for particles
+    };
+
+    /**
+     * @param impostorDistance Clouds whose centre is further away use an impostor
+     * @param softDistance Particles fade out when the camera gets this close
+     */
+    CloudImpostors(float impostorDistance = 700.0f, float softDistance = 60.0f);
+    ~CloudImpostors();
+
+    // Simulation side: sprites for this frame, sorted far to near
+    void build(const AnimationSystem &animation, const glm::mat4 &view, glm::vec3 viewPos,
+               std::vector<Sprite> &out) const;
+
+    // Rendering (requires a current GL context). The atlas is composited
+    // from each cloud's own ellipsoids, drawn with the square RGB puff image
+    // that the particles also use
+    void initRendering(const AnimationSystem &animation, const unsigned char *puff, int puffSize);
+    void upload(const std::vector<Sprite> &sprites);
+    void draw(Shader &shader, Texture *puffTexture, int firstUnit) const;
+
+    /**
+     * Composite the atlas texels (RGB, ATLAS_COLUMNS * TILE_SIZE wide and
+     * atlasRows(clouds) * TILE_SIZE high) from a puff image of any size. No GL
+     * and only the clouds' fixed layout is read, so a rebake after the puff
+     * changed can run on any thread and be uploaded to getAtlasTexture()
+     */
+    static void bakeAtlas(const AnimationSystem &animation, const unsigned char *puff, int puffSize,
+                          unsigned char *atlasPixels);
+    GLuint getAtlasTexture() const;
+
+private:
+    float impostorDistance, softDistance;
+
+    Texture *atlas;
+    Mesh *quad;
+    GLuint instanceBuffer;
+    GLsizei uploadedCount;
+};
+
+#endif
@@ -0,0 +1,394 @@
+#include "Flock.h"
+#include "JobSystem.h"
+#include "../Shader.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Neighbourhood
+    const float NEIGHBOUR_RADIUS = 3.0f;  // Also the hash cell size
+    const float SEPARATION_RADIUS = 1.0f;
+    const int MAX_NEIGHBOURS = 12;        // Bounded work per bird in dense clumps
+
+    // Steering weights
+    const float SEPARATION_WEIGHT = 6.0f;
+    const float ALIGNMENT_WEIGHT = 1.2f;
+    const float COHESION_WEIGHT = 0.6f;
+    const float BOUNDS_WEIGHT = 8.0f;
+    const float BOUNDS_MARGIN = 10.0f;
+    const float ALTITUDE_SPRING = 0.8f;   // Pull towards cruising altitude
+
+    const float MIN_SPEED = 4.0f;
+    const float MAX_SPEED = 9.0f;
+    const float GROUND_HEIGHT = 0.5f;
+    const float DESCENT_SPEED = 3.0f;
+    const float ASCENT_SPEED = 4.0f;
+    const float FLAP_SPEED = 8.0f;
+
+    const unsigned int NO_CELL = 0xFFFFFFFFu;
+    const size_t BIRDS_PER_JOB = 256;
+
+    inline bool isAirborne(unsigned char s) { return s != Bird::ON_GROUND; }
+    inline int cellCoord(float v) { return static_cast<int>(std::floor(v / NEIGHBOUR_RADIUS)); }
+}
+
+Flock::Flock(int count, glm::vec3 bMin, glm::vec3 bMax, unsigned int seed)
+    : boundsMin(bMin), boundsMax(bMax), birdModel(nullptr), instanceVBO(0), uploadedCount(0)
+{
+    posX.resize(count); posY.resize(count); posZ.resize(count);
+    velX.resize(count); velY.resize(count); velZ.resize(count);
+    steerX.resize(count); steerY.resize(count); steerZ.resize(count);
+    baseHeight.resize(count);
+    flapTime.resize(count);
+    stateTime.resize(count);
+    nextLanding.resize(count);
+    maxGroundTime.resize(count);
+    state.resize(count, Bird::FLYING);
+    rng.resize(count);
+    birdCell.resize(count, NO_CELL);
+    instances.resize(count);
+
+    // Hash table: power of two, at least 2 slots per bird
+    unsigned int tableSize = 1024;
+    while (tableSize < 2u * static_cast<unsigned int>(count))
+        tableSize <<= 1;
+    tableMask = tableSize - 1;
+    cellStart.resize(tableSize + 1);
+    cellEntries.resize(count);
+
+    for (int i = 0; i < count; i++)
+    {
+        rng[i] = seed ^ (0x9E3779B9u * static_cast<unsigned int>(i + 1));
+        if (rng[i] == 0)
+            rng[i] = 1;
+
+        posX[i] = glm::mix(bMin.x, bMax.x, random01(i));
+        posZ[i] = glm::mix(bMin.z, bMax.z, random01(i));
+        baseHeight[i] = glm::mix(bMin.y + 0.4f * (bMax.y - bMin.y), bMax.y, random01(i));
+        posY[i] = baseHeight[i];
+
+        float heading = random01(i) * 6.2831853f;
+        velX[i] = std::sin(heading) * MIN_SPEED;
+        velY[i] = 0.0f;
+        velZ[i] = std::cos(heading) * MIN_SPEED;
+
+        flapTime[i] = random01(i) * 6.2831853f;
+        stateTime[i] = 0.0f;
+        nextLanding[i] = 10.0f + random01(i) * 20.0f;   // 10-30 seconds
+        maxGroundTime[i] = 5.0f + random01(i) * 5.0f;   // 5-10 seconds on ground
+    }
+
+    prevX = posX; prevY = posY; prevZ = posZ;
+    prevFlapTime = flapTime;
+}
+
+Flock::~Flock()
+{
+    delete birdModel;
+    if (instanceVBO != 0)
+        glDeleteBuffers(1, &instanceVBO);
+}
+
+float Flock::random01(size_t bird)
+{
+    // xorshift32: one independent stream per bird, safe to call from workers
+    unsigned int x = rng[bird];
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng[bird] = x;
+    return (x >> 8) * (1.0f / 16777216.0f);
+}
+
+unsigned int Flock::cellHash(int x, int y, int z) const
+{
+    unsigned int h = (static_cast<unsigned int>(x) * 73856093u) ^
+                     (static_cast<unsigned int>(y) * 19349663u) ^
+                     (static_cast<unsigned int>(z) * 83492791u);
+    return h & tableMask;
+}
+
+void Flock::update(float deltaTime, JobSystem *jobs)
+{
+    prevX = posX; prevY = posY; prevZ = posZ;
+    prevFlapTime = flapTime;
+
+    buildGrid();
+
+    if (!jobs)
+    {
+        steer(0, size(), deltaTime);
+        integrate(0, size(), deltaTime);
+        return;
+    }
+
+    // Steering reads every bird's current state and writes steerX/Y/Z only
+    jobs->parallel_for(size(), BIRDS_PER_JOB, [this, deltaTime](size_t begin, size_t end)
+                       { steer(begin, end, deltaTime); });
+
+    // Integration touches each bird's own state only
+    jobs->parallel_for(size(), BIRDS_PER_JOB, [this, deltaTime](size_t begin, size_t end)
+                       { integrate(begin, end, deltaTime); });
+}
+
+void Flock::buildGrid()
+{
+    const size_t count = size();
+    std::fill(cellStart.begin(), cellStart.end(), 0u);
+
+    // Count airborne birds per cell
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!isAirborne(state[i]))
+        {
+            birdCell[i] = NO_CELL;
+            continue;
+        }
+        unsigned int cell = cellHash(cellCoord(posX[i]), cellCoord(posY[i]), cellCoord(posZ[i]));
+        birdCell[i] = cell;
+        cellStart[cell + 1]++;
+    }
+
+    // Prefix sum -> start offsets
+    for (size_t c = 1; c < cellStart.size(); c++)
+        cellStart[c] += cellStart[c - 1];
+
+    // Scatter (cellStart[c] is used as the write cursor, then restored)
+    for (size_t i = 0; i < count; i++)
+    {
+        if (birdCell[i] != NO_CELL)
+            cellEntries[cellStart[birdCell[i]]++] = static_cast<unsigned int>(i);
+    }
+    for (size_t c = cellStart.size() - 1; c > 0; c--)
+        cellStart[c] = cellStart[c - 1];
+    cellStart[0] = 0;
+}
+
+void Flock::steer(size_t begin, size_t end, float deltaTime)
+{
+    const float radius2 = NEIGHBOUR_RADIUS * NEIGHBOUR_RADIUS;
+    const float separation2 = SEPARATION_RADIUS * SEPARATION_RADIUS;
+
+    for (size_t i = begin; i < end; i++)
+    {
+        if (!isAirborne(state[i]))
+        {
+            steerX[i] = steerY[i] = steerZ[i] = 0.0f;
+            continue;
+        }
+
+        const float px = posX[i], py = posY[i], pz = posZ[i];
+        const int cx = cellCoord(px), cy = cellCoord(py), cz = cellCoord(pz);
+
+        float sepX = 0.0f, sepY = 0.0f, sepZ = 0.0f;
+        float aliX = 0.0f, aliY = 0.0f, aliZ = 0.0f;
+        float cohX = 0.0f, cohY = 0.0f, cohZ = 0.0f;
+        int neighbours = 0;
+
+        // 3x3x3 cells around the bird. Several cells can hash to the same
+        // bucket, so each bucket is scanned once; birds it holds from other
+        // cells are filtered by distance
+        unsigned int visited[27];
+        int visitedCount = 0;
+        for (int dz = -1; dz <= 1 && neighbours < MAX_NEIGHBOURS; dz++)
+            for (int dy = -1; dy <= 1 && neighbours < MAX_NEIGHBOURS; dy++)
+                for (int dx = -1; dx <= 1 && neighbours < MAX_NEIGHBOURS; dx++)
+                {
+                    unsigned int cell = cellHash(cx + dx, cy + dy, cz + dz);
+                    if (std::find(visited, visited + visitedCount, cell) != visited + visitedCount)
+                        continue;
+                    visited[visitedCount++] = cell;
+
+                    for (unsigned int k = cellStart[cell]; k < cellStart[cell + 1]; k++)
+                    {
+                        unsigned int j = cellEntries[k];
+                        if (j == i)
+                            continue;
+
+                        float ox = posX[j] - px, oy = posY[j] - py, oz = posZ[j] - pz;
+                        float d2 = ox * ox + oy * oy + oz * oz;
+                        if (d2 >= radius2)
+                            continue;
+
+                        aliX += velX[j]; aliY += velY[j]; aliZ += velZ[j];
+                        cohX += ox; cohY += oy; cohZ += oz;
+                        if (d2 < separation2)
+                        {
+                            float inv = 1.0f / std::max(d2, 0.01f);
+                            sepX -= ox * inv; sepY -= oy * inv; sepZ -= oz * inv;
+                        }
+                        if (++neighbours >= MAX_NEIGHBOURS)
+                            break;
+                    }
+                }
+
+        float ax = sepX * SEPARATION_WEIGHT;
+        float ay = sepY * SEPARATION_WEIGHT;
+        float az = sepZ * SEPARATION_WEIGHT;
+        if (neighbours > 0)
+        {
+            float inv = 1.0f / neighbours;
+            ax += (aliX * inv - velX[i]) * ALIGNMENT_WEIGHT + cohX * inv * COHESION_WEIGHT;
+            ay += (aliY * inv - velY[i]) * ALIGNMENT_WEIGHT + cohY * inv * COHESION_WEIGHT;
+            az += (aliZ * inv - velZ[i]) * ALIGNMENT_WEIGHT + cohZ * inv * COHESION_WEIGHT;
+        }
+
+        // Turn back before leaving the plaza
+        if (px < boundsMin.x + BOUNDS_MARGIN) ax += BOUNDS_WEIGHT;
+        if (px > boundsMax.x - BOUNDS_MARGIN) ax -= BOUNDS_WEIGHT;
+        if (pz < boundsMin.z + BOUNDS_MARGIN) az += BOUNDS_WEIGHT;
+        if (pz > boundsMax.z - BOUNDS_MARGIN) az -= BOUNDS_WEIGHT;
+
+        // Cruising birds hold their altitude
+        if (state[i] == Bird::FLYING)
+            ay += (baseHeight[i] - py) * ALTITUDE_SPRING;
+
+        float vx = velX[i] + ax * deltaTime;
+        float vy = velY[i] + ay * deltaTime;
+        float vz = velZ[i] + az * deltaTime;
+
+        // Clamp speed
+        float speed = std::sqrt(vx * vx + vy * vy + vz * vz);
+        float clamped = std::min(std::max(speed, MIN_SPEED), MAX_SPEED);
+        float scale = speed > 0.0001f ? clamped / speed : 0.0f;
+        steerX[i] = vx * scale;
+        steerY[i] = vy * scale;
+        steerZ[i] = vz * scale;
+    }
+}
+
+void Flock::integrate(size_t begin, size_t end, float deltaTime)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        switch (state[i])
+        {
+        case Bird::FLYING:
+            velX[i] = steerX[i]; velY[i] = steerY[i]; velZ[i] = steerZ[i];
+            stateTime[i] += deltaTime;
+            // Check if it's time to land
+            if (stateTime[i] > nextLanding[i])
+            {
+                state[i] = Bird::LANDING;
+                stateTime[i] = 0.0f;
+            }
+            break;
+
+        case Bird::LANDING:
+            // Glide down while slowing horizontally
+            velX[i] = steerX[i] * 0.5f; velY[i] = -DESCENT_SPEED; velZ[i] = steerZ[i] * 0.5f;
+            if (posY[i] + velY[i] * deltaTime <= GROUND_HEIGHT)
+            {
+                posY[i] = GROUND_HEIGHT;
+                velX[i] = velY[i] = velZ[i] = 0.0f;
+                state[i] = Bird::ON_GROUND;
+                stateTime[i] = 0.0f;
+            }
+            break;
+
+        case Bird::ON_GROUND:
+            stateTime[i] += deltaTime;
+            if (stateTime[i] > maxGroundTime[i])
+            {
+                state[i] = Bird::TAKING_OFF;
+                stateTime[i] = 0.0f;
+                nextLanding[i] = 15.0f + random01(i) * 20.0f;
+                // Leave the ground in a random direction
+                float heading = random01(i) * 6.2831853f;
+                velX[i] = std::sin(heading) * MIN_SPEED;
+                velZ[i] = std::cos(heading) * MIN_SPEED;
+            }
+            break;
+
+        case Bird::TAKING_OFF:
+            velX[i] = steerX[i]; velY[i] = ASCENT_SPEED; velZ[i] = steerZ[i];
+            if (posY[i] >= baseHeight[i])
+            {
+                posY[i] = baseHeight[i];
+                state[i] = Bird::FLYING;
+            }
+            break;
+        }
+
+        posX[i] += velX[i] * deltaTime;
+        posY[i] += velY[i] * deltaTime;
+        posZ[i] += velZ[i] * deltaTime;
+
+        // Flap while airborne, fold wings on the ground
+        flapTime[i] = isAirborne(state[i]) ? flapTime[i] + FLAP_SPEED * deltaTime : 0.0f;
+    }
+}
+
+void Flock::writeInstances(float alpha)
+{
+    const size_t count = size();
+    for (size_t i = 0; i < count; i++)
+    {
+        float x = prevX[i] + (posX[i] - prevX[i]) * alpha;
+        float y = prevY[i] + (posY[i] - prevY[i]) * alpha;
+        float z = prevZ[i] + (posZ[i] - prevZ[i]) * alpha;
+        float wingTime = prevFlapTime[i] + (flapTime[i] - prevFlapTime[i]) * alpha;
+
+        float horizontal = std::sqrt(velX[i] * velX[i] + velZ[i] * velZ[i]);
+        float yaw = horizontal > 0.001f ? std::atan2(velX[i], velZ[i]) : instances[i].positionYaw.w;
+        float pitch = std::atan2(velY[i], std::max(horizontal, 0.001f));
+        float flap = std::sin(wingTime) * 30.0f;
+
+        instances[i].positionYaw = glm::vec4(x, y, z, yaw);
+        instances[i].flapPitch = glm::vec4(flap, pitch, 0.0f, 0.0f);
+    }
+}
+
+void Flock::initRendering()
+{
+    birdModel = new Bird();
+
+    glGenBuffers(1, &instanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(Instance), instances.data(), GL_STREAM_DRAW);
+
+    // Every part mesh reads the same per-bird attributes
+    for (int part = 0; part < Bird::PART_COUNT; part++)
+        birdModel->parts[part]->setInstanceAttributes(instanceVBO, 3, 2, sizeof(Instance));
+}
+
+void Flock::uploadInstances(const std::vector<Instance> &frameInstances)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    // Orphan the previous storage so the driver does not stall on in-flight draws
+    glBufferData(GL_ARRAY_BUFFER, frameInstances.size() * sizeof(Instance), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, frameInstances.size() * sizeof(Instance), frameInstances.data());
+    uploadedCount = static_cast<GLsizei>(frameInstances.size());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Flock::draw(Shader &shader)
+{
+    if (!birdModel || uploadedCount == 0)
+        return;
+
+    for (int part = 0; part < Bird::PART_COUNT; part++)
+    {
+        shader.setVec3("partOffset", Bird::partOffset(part));
+        shader.setFloat("partFlapSign", Bird::partFlapSign(part));
+        shader.setFloat("partTilt", glm::radians(Bird::partTiltDegrees(part)));
+        birdModel->parts[part]->drawInstanced(uploadedCount);
+    }
+}
+
+void Flock::drawShadowCasters(Shader &shader)
+{
+    if (!birdModel || uploadedCount == 0)
+        return;
+
+    for (int part = 0; part < Bird::PART_COUNT; part++)
+    {
+        if (!birdModel->parts[part]->castsShadow)
+            continue;
+        shader.setVec3("partOffset", Bird::partOffset(part));
+        shader.setFloat("partFlapSign", Bird::partFlapSign(part));
+        shader.setFloat("partTilt", glm::radians(Bird::partTiltDegrees(part)));
+        birdModel->parts[part]->drawInstanced(uploadedCount);
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef FLOCK_H
+#define FLOCK_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include "Bird.h"
+
+class JobSystem;
+class Shader;
+
+/**
+ * Pigeon flock - boids (separation / alignment / cohesion) combined with the
+ * FLYING / LANDING / ON_GROUND / TAKING_OFF state machine
+ * State is struct-of-arrays; neighbours are found through a uniform spatial
+ * hash so each query touches a bounded number of cells. Rendering uses one
+ * instanced draw per bird part (shaders/bird_instanced.vs).
+ */
+class Flock
+{
+public:
+    // Per-bird GPU data (divisor 1, attribute locations 3 and 4)
+    struct Instance
+    {
+        glm::vec4 positionYaw; // xyz = position, w = heading (radians)
+        glm::vec4 flapPitch;   // x = wing angle (degrees), y = pitch (radians)
+    };
+
+    /**
+     * @param count Number of pigeons
+     * @param boundsMin / boundsMax Box the flock is steered to stay inside
+     * @param seed Seed for the per-bird random streams (deterministic runs)
+     */
+    Flock(int count, glm::vec3 boundsMin, glm::vec3 boundsMax, unsigned int seed = 1234u);
+    ~Flock();
+
+    // Simulation (no GL calls, usable headless)
+    void update(float deltaTime, JobSystem *jobs = nullptr);
+    void writeInstances(float alpha = 1.0f); // Blend previous -> current step
+
+    size_t size() const { return posX.size(); }
+    const std::vector<Instance> &getInstances() const { return instances; }
+
+    // Rendering (requires a current GL context)
+    void initRendering();
+    void uploadInstances(const std::vector<Instance> &frameInstances);
+    void draw(Shader &shader);
+    void drawShadowCasters(Shader &shader); // Parts with castsShadow only
+
+private:
+    void buildGrid();
+    void steer(size_t begin, size_t end, float deltaTime);
+    void integrate(size_t begin, size_t end, float deltaTime);
+    float random01(size_t bird);
+    unsigned int cellHash(int x, int y, int z) const;
+
+    glm::vec3 boundsMin, boundsMax;
+
+    // ===== Bird state (SoA) =====
+    std::vector<float> posX, posY, posZ;
+    std::vector<float> prevX, prevY, prevZ;    // Positions before the last step
+    std::vector<float> velX, velY, velZ;
+    std::vector<float> steerX, steerY, steerZ; // Velocity after steering (double buffer)
+    std::vector<float> baseHeight;             // Cruising altitude
+    std::vector<float> flapTime;
+    std::vector<float> prevFlapTime;
+    std::vector<float> stateTime;              // Time in FLYING or ON_GROUND
+    std::vector<float> nextLanding;
+    std::vector<float> maxGroundTime;
+    std::vector<unsigned char> state;          // Bird::State
+    std::vector<unsigned int> rng;             // xorshift32 per bird
+
+    // ===== Spatial hash (counting sort of airborne birds) =====
+    std::vector<unsigned int> cellStart;       // tableSize + 1 prefix offsets
+    std::vector<unsigned int> cellEntries;     // Bird indices grouped by cell
+    std::vector<unsigned int> birdCell;        // Cell of each bird (or NO_CELL)
+    unsigned int tableMask;
+
+    // ===== Rendering =====
+    std::vector<Instance> instances;
+    Bird *birdModel;
+    GLuint instanceVBO;
+    GLsizei uploadedCount; // Instances in the GPU buffer (render thread side)
+};
+
+#endif
@@ -0,0 +1,32 @@
+#include "FrameLimiter.h"
+#include <thread>
+
+namespace
+{
+    // Sleeps overshoot by up to a scheduler tick; the rest is spent yielding
+    const std::chrono::microseconds SPIN_WINDOW(1500);
+}
+
+FrameLimiter::FrameLimiter(float framesPerSecond)
+    : period(framesPerSecond > 0.0f ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                          std::chrono::duration<double>(1.0 / framesPerSecond))
+                                    : std::chrono::steady_clock::duration::zero()),
+      next(std::chrono::steady_clock::now())
+{
+}
+
+void FrameLimiter::wait()
+{
+    if (period == std::chrono::steady_clock::duration::zero())
+        return;
+
+    auto now = std::chrono::steady_clock::now();
+    if (next - now > SPIN_WINDOW)
+        std::this_thread::sleep_until(next - SPIN_WINDOW);
+    while (std::chrono::steady_clock::now() < next)
+        std::this_thread::yield();
+
+    // Late by more than a frame: resync rather than catch up
+    now = std::chrono::steady_clock::now();
+    next = now - next > period ? now + period : next + period;
+}
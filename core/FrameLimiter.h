@@ -0,0 +1,25 @@
+#ifndef FRAMELIMITER_H
+#define FRAMELIMITER_H
+
+#include <chrono>
+
+/**
+ * Caps the simulation loop at a frame rate
+ * wait() sleeps until the next frame slot, so the wait happens before input
+ * is sampled rather than after the frame was built. A frame that ran long
+ * starts the schedule again instead of being followed by a burst of short
+ * ones. A rate of 0 never waits.
+ */
+class FrameLimiter
+{
+public:
+    explicit FrameLimiter(float framesPerSecond);
+
+    void wait();
+
+private:
+    std::chrono::steady_clock::duration period;
+    std::chrono::steady_clock::time_point next;
+};
+
+#endif
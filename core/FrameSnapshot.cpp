@@ -0,0 +1,61 @@
+#include "FrameSnapshot.h"
+#include <utility>
+
+FrameExchange::FrameExchange(int jobThreadCount)
+    : writeSlot(0), readySlot(1), readSlot(2), hasReady(false), consumerWaiting(false), closed(false)
+{
+    for (int i = 0; i < 3; i++)
+        slots[i] = new FrameSnapshot(jobThreadCount);
+}
+
+FrameExchange::~FrameExchange()
+{
+    for (int i = 0; i < 3; i++)
+        delete slots[i];
+}
+
+void FrameExchange::publish()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this]()
+                 { return !hasReady || closed; });
+    if (closed)
+        return;
+
+    std::swap(writeSlot, readySlot);
+    hasReady = true;
+    changed.notify_all();
+}
+
+void FrameExchange::waitUntilWanted()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this]()
+                 { return (consumerWaiting && !hasReady) || closed; });
+}
+
+const FrameSnapshot *FrameExchange::acquireLatest()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    consumerWaiting = true;
+    changed.notify_all();
+    changed.wait(lock, [this]()
+                 { return hasReady || closed; });
+    consumerWaiting = false;
+    if (!hasReady)
+        return nullptr;
+
+    std::swap(readSlot, readySlot);
+    hasReady = false;
+    changed.notify_all();
+    return slots[readSlot];
+}
+
+void FrameExchange::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+    }
+    changed.notify_all();
+}
@@ -0,0 +1,103 @@
+#ifndef FRAMESNAPSHOT_H
+#define FRAMESNAPSHOT_H
+
+#include <glm/glm.hpp>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include "CloudImpostors.h"
+#include "Flock.h"
+#include "LightClusters.h"
+#include "RenderQueue.h"
+#include "ShadowCascades.h"
+
+// Per-frame lighting state shared by every program that uses lighting_v4.fs
+struct FrameLighting
+{
+    glm::mat4 projection;
+    glm::mat4 view;
+    ShadowCascades::Frame shadows;
+    glm::vec3 viewPos;
+    glm::vec3 sunDir;
+    glm::vec3 sunColor;
+    float ambientStrength;
+    bool isNight;
+    float time;
+};
+
+/**
+ * Everything the render thread needs to draw one frame
+ * Written by the simulation thread, then handed over and never modified
+ * until the render thread has moved on to a newer frame.
+ */
+struct FrameSnapshot
+{
+    explicit FrameSnapshot(int jobThreadCount)
+        : cameraQueue(jobThreadCount) {}
+
+    FrameLighting lighting;
+    glm::vec3 skyColor;
+    double inputTime; // FramePacer::now() when input was sampled for this frame
+
+    // Forward path options (toggled by key on the simulation thread)
+    bool depthPrepass;
+    bool showOverdraw;
+
+    // Sprite cloud puff slice; the render thread redraws the texture when it changes
+    float cloudPuffSeed;
+
+    // Flag cloth
+    float flagWaveTime;
+    float flagRaise;
+
+    // Animated instances
+    std::vector<glm::mat4> guardTransforms; // Guard::PART_COUNT per guard
+    std::vector<CloudImpostors::Sprite> cloudSprites; // Sorted far to near
+    std::vector<Flock::Instance> pigeonInstances;
+
+    // Street lights binned against this frame's camera
+    LightClusters::Grid lightGrid;
+
+    // Culled, LOD-selected trees and buildings for the camera (the shadow
+    // pass draws the static ShadowCasters list instead)
+    RenderQueue cameraQueue;
+};
+
+/**
+ * Triple buffer of frame snapshots between the simulation and render threads
+ * The simulation fills the write slot and publishes it; the render thread
+ * always picks up the newest published frame. publish() waits while the
+ * previous frame has not been picked up, so the simulation runs at most one
+ * frame ahead of submission. For low latency the simulation can instead
+ * wait before sampling input until the render thread is idle and asking for
+ * a frame, so the two never overlap.
+ */
+class FrameExchange
+{
+public:
+    explicit FrameExchange(int jobThreadCount);
+    ~FrameExchange();
+
+    // Simulation thread
+    FrameSnapshot &beginWrite() { return *slots[writeSlot]; }
+    void publish();
+    // Until the render thread waits for a frame and none is ready
+    void waitUntilWanted();
+
+    // Render thread: valid until the next call; nullptr once closed
+    const FrameSnapshot *acquireLatest();
+
+    // Wake both sides and stop handing out frames
+    void close();
+
+private:
+    FrameSnapshot *slots[3];
+    int writeSlot, readySlot, readSlot;
+    bool hasReady;
+    bool consumerWaiting; // Render thread blocked in acquireLatest
+    bool closed;
+    std::mutex mutex;
+    std::condition_variable changed;
+};
+
+#endif
@@ -0,0 +1,116 @@
+#include "JobSystem.h"
+
+namespace
+{
+    thread_local int threadIndex = 0;
+}
+
+JobSystem::JobSystem(int threadCount)
+    : running(true), queued(0)
+{
+    if (threadCount <= 0)
+        threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+    for (int i = 0; i < threadCount; i++)
+        queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+
+    for (int i = 1; i < threadCount; i++)
+        workers.emplace_back(&JobSystem::workerLoop, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        running = false;
+    }
+    wake.notify_all();
+    for (auto &worker : workers)
+        worker.join();
+}
+
+int JobSystem::currentThreadIndex()
+{
+    return threadIndex;
+}
+
+void JobSystem::run(Job job, Counter &counter)
+{
+    counter.pending.fetch_add(1);
+    {
+        WorkQueue &queue = *queues[threadIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.entries.push_back(Entry{std::move(job), &counter});
+    }
+
+    // Taking the sleep lock orders the increment against a worker's wait check
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        queued.fetch_add(1);
+    }
+    wake.notify_one();
+}
+
+void JobSystem::wait(Counter &counter)
+{
+    while (counter.pending.load() > 0)
+    {
+        if (!runOne(threadIndex))
+            std::this_thread::yield();
+    }
+}
+
+bool JobSystem::popLocal(int index, Entry &out)
+{
+    WorkQueue &queue = *queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.entries.empty())
+        return false;
+    out = std::move(queue.entries.back()); // Newest first: still warm in cache
+    queue.entries.pop_back();
+    return true;
+}
+
+bool JobSystem::steal(int thief, Entry &out)
+{
+    const int count = static_cast<int>(queues.size());
+    for (int offset = 1; offset < count; offset++)
+    {
+        WorkQueue &victim = *queues[(thief + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.entries.empty())
+            continue;
+        out = std::move(victim.entries.front()); // Oldest first: usually the biggest piece
+        victim.entries.pop_front();
+        return true;
+    }
+    return false;
+}
+
+bool JobSystem::runOne(int index)
+{
+    Entry entry;
+    if (!popLocal(index, entry) && !steal(index, entry))
+        return false;
+
+    queued.fetch_sub(1);
+    entry.job();
+    entry.counter->pending.fetch_sub(1);
+    return true;
+}
+
+void JobSystem::workerLoop(int index)
+{
+    threadIndex = index;
+    while (true)
+    {
+        if (runOne(index))
+            continue;
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this]()
+                  { return !running || queued.load() > 0; });
+        if (!running)
+            return;
+    }
+}
@@ -0,0 +1,105 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Work-stealing job scheduler
+ * Every thread (the owning thread is index 0, workers are 1..N-1) has its own
+ * deque: it pushes and pops at the back, idle threads steal from the front.
+ * wait() runs queued jobs instead of blocking, so jobs may wait on nested work.
+ * run / wait / parallel_for are meant to be called from the owning thread or
+ * from inside a job.
+ */
+class JobSystem
+{
+public:
+    typedef std::function<void()> Job;
+
+    // Completion counter for a group of jobs
+    struct Counter
+    {
+        std::atomic<int> pending{0};
+    };
+
+    /**
+     * @param threadCount Total threads including the caller (0 = one per core)
+     */
+    explicit JobSystem(int threadCount = 0);
+    ~JobSystem();
+
+    void run(Job job, Counter &counter);
+    void wait(Counter &counter);
+
+    /**
+     * Call fn(begin, end) over [0, count) in chunks of grainSize
+     * (0 = about four chunks per thread). The caller takes the first chunk.
+     */
+    template <typename Fn>
+    void parallel_for(size_t count, size_t grainSize, Fn fn);
+
+    int getThreadCount() const { return static_cast<int>(queues.size()); }
+
+    // Index of the calling thread inside its job system (0 for other threads)
+    static int currentThreadIndex();
+
+private:
+    struct Entry
+    {
+        Job job;
+        Counter *counter;
+    };
+
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<Entry> entries;
+    };
+
+    bool popLocal(int index, Entry &out);
+    bool steal(int thief, Entry &out);
+    bool runOne(int index);
+    void workerLoop(int index);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues; // One per thread
+    std::vector<std::thread> workers;
+    std::atomic<bool> running;
+    std::atomic<int> queued;                        // Jobs waiting in any deque
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+};
+
+template <typename Fn>
+void JobSystem::parallel_for(size_t count, size_t grainSize, Fn fn)
+{
+    if (count == 0)
+        return;
+    if (grainSize == 0)
+        grainSize = std::max<size_t>(1, count / (queues.size() * 4));
+    if (queues.size() == 1 || count <= grainSize)
+    {
+        fn(size_t(0), count);
+        return;
+    }
+
+    Counter counter;
+    for (size_t begin = grainSize; begin < count; begin += grainSize)
+    {
+        size_t end = std::min(count, begin + grainSize);
+        run([&fn, begin, end]()
+            { fn(begin, end); },
+            counter);
+    }
+    fn(size_t(0), grainSize);
+    wait(counter);
+}
+
+#endif
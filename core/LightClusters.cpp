@@ -0,0 +1,204 @@
+#include "LightClusters.h"
+#include "../Shader.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    const float LIGHT_CUTOFF = 0.02f; // Contribution treated as zero
+    const int TEXELS_PER_LIGHT = 4;
+
+    enum Buffer
+    {
+        CELLS,
+        INDICES,
+        LIGHTS
+    };
+}
+
+LightClusters::LightClusters(float nearDepth, float farDepth)
+    : sliceNear(nearDepth), sliceFar(farDepth)
+{
+    for (int i = 0; i < 3; i++)
+        buffers[i] = textures[i] = 0;
+}
+
+LightClusters::~LightClusters()
+{
+    if (buffers[0] != 0)
+    {
+        glDeleteTextures(3, textures);
+        glDeleteBuffers(3, buffers);
+    }
+}
+
+float LightClusters::lightRadius(const PointLight &light)
+{
+    float brightest = std::max(std::max(light.diffuse.x, light.diffuse.y), light.diffuse.z);
+    brightest = std::max(brightest, std::max(std::max(light.ambient.x, light.ambient.y), light.ambient.z));
+    brightest = std::max(brightest, std::max(std::max(light.specular.x, light.specular.y), light.specular.z));
+
+    // Solve brightest / (constant + linear*d + quadratic*d^2) = LIGHT_CUTOFF
+    float k = brightest / LIGHT_CUTOFF - light.constant;
+    if (k <= 0.0f)
+        return 0.0f;
+    if (light.quadratic <= 0.0f)
+        return light.linear > 0.0f ? k / light.linear : 0.0f;
+    return (-light.linear + std::sqrt(light.linear * light.linear + 4.0f * light.quadratic * k)) / (2.0f * light.quadratic);
+}
+
+void LightClusters::bin(const std::vector<PointLight> &pointLights, const glm::mat4 &view,
+                        float fovY, float aspect, float cameraFar, Grid &out) const
+{
+    out.cells.assign(CLUSTER_COUNT * 2, 0u);
+    out.indices.clear();
+    out.lights.clear();
+
+    const float tanY = std::tan(fovY * 0.5f);
+    const float tanX = tanY * aspect;
+    const float logRatio = std::log(sliceFar / sliceNear);
+
+    auto sliceOf = [&](float depth)
+    {
+        if (depth <= sliceNear)
+            return 0;
+        int slice = static_cast<int>(std::log(depth / sliceNear) / logRatio * SLICES);
+        return std::min(slice, SLICES - 1);
+    };
+    auto sliceStart = [&](int slice)
+    {
+        return slice == 0 ? 0.0f : sliceNear * std::pow(sliceFar / sliceNear, static_cast<float>(slice) / SLICES);
+    };
+
+    // (cluster, light) pairs, then a counting sort into per-cluster lists
+    std::vector<GLuint> pairCluster, pairLight;
+
+    for (const PointLight &light : pointLights)
+    {
+        // Unlit lamps (street lights by day) cost nothing
+        float radius = lightRadius(light);
+        if (radius <= 0.0f)
+            continue;
+
+        glm::vec4 center = view * glm::vec4(light.position, 1.0f);
+        float depth = -center.z;
+        if (depth + radius < 0.0f || depth - radius > cameraFar)
+            continue;
+
+        GLuint lightIndex = static_cast<GLuint>(out.lights.size() / TEXELS_PER_LIGHT);
+        out.lights.push_back(glm::vec4(light.position, radius));
+        out.lights.push_back(glm::vec4(light.ambient, light.constant));
+        out.lights.push_back(glm::vec4(light.diffuse, light.linear));
+        out.lights.push_back(glm::vec4(light.specular, light.quadratic));
+
+        const float radius2 = radius * radius;
+        const int lastSlice = sliceOf(depth + radius);
+        for (int k = sliceOf(std::max(depth - radius, 0.0f)); k <= lastSlice; k++)
+        {
+            float zNear = sliceStart(k);
+            float zFar = k == SLICES - 1 ? cameraFar : sliceStart(k + 1);
+            float dz = std::max(std::max(zNear - depth, depth - zFar), 0.0f);
+            if (dz * dz > radius2)
+                continue;
+
+            for (int i = 0; i < TILES_X; i++)
+            {
+                // Tile bounds in view space: NDC x scaled by depth (widest at zFar)
+                float ndc0 = -1.0f + 2.0f * i / TILES_X;
+                float ndc1 = ndc0 + 2.0f / TILES_X;
+                float minX = std::min(ndc0 * zNear, ndc0 * zFar) * tanX;
+                float maxX = std::max(ndc1 * zNear, ndc1 * zFar) * tanX;
+                float dx = std::max(std::max(minX - center.x, center.x - maxX), 0.0f);
+                if (dx * dx + dz * dz > radius2)
+                    continue;
+
+                for (int j = 0; j < TILES_Y; j++)
+                {
+                    float ndcY0 = -1.0f + 2.0f * j / TILES_Y;
+                    float ndcY1 = ndcY0 + 2.0f / TILES_Y;
+                    float minY = std::min(ndcY0 * zNear, ndcY0 * zFar) * tanY;
+                    float maxY = std::max(ndcY1 * zNear, ndcY1 * zFar) * tanY;
+                    float dy = std::max(std::max(minY - center.y, center.y - maxY), 0.0f);
+                    if (dx * dx + dy * dy + dz * dz > radius2)
+                        continue;
+
+                    pairCluster.push_back(static_cast<GLuint>((k * TILES_Y + j) * TILES_X + i));
+                    pairLight.push_back(lightIndex);
+                }
+            }
+        }
+    }
+
+    // Count, prefix sum into offsets, scatter
+    for (GLuint cluster : pairCluster)
+        out.cells[cluster * 2 + 1]++;
+
+    GLuint offset = 0;
+    for (int c = 0; c < CLUSTER_COUNT; c++)
+    {
+        out.cells[c * 2] = offset;
+        offset += out.cells[c * 2 + 1];
+        out.cells[c * 2 + 1] = 0; // Reused as the write cursor
+    }
+
+    out.indices.resize(pairCluster.size());
+    for (size_t p = 0; p < pairCluster.size(); p++)
+    {
+        GLuint *cell = &out.cells[pairCluster[p] * 2];
+        out.indices[cell[0] + cell[1]++] = pairLight[p];
+    }
+}
+
+void LightClusters::initRendering()
+{
+    glGenBuffers(3, buffers);
+    glGenTextures(3, textures);
+
+    Grid empty;
+    empty.cells.assign(CLUSTER_COUNT * 2, 0u);
+    upload(empty);
+}
+
+void LightClusters::uploadBuffer(int buffer, GLenum format, const void *data, size_t bytes)
+{
+    glBindBuffer(GL_TEXTURE_BUFFER, buffers[buffer]);
+    // Orphan, then fill; never zero-sized so the texture view stays valid
+    glBufferData(GL_TEXTURE_BUFFER, std::max<size_t>(bytes, 16), nullptr, GL_STREAM_DRAW);
+    if (bytes > 0)
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, bytes, data);
+
+    glBindTexture(GL_TEXTURE_BUFFER, textures[buffer]);
+    glTexBuffer(GL_TEXTURE_BUFFER, format, buffers[buffer]);
+}
+
+void LightClusters::upload(const Grid &grid)
+{
+    uploadBuffer(CELLS, GL_RG32UI, grid.cells.data(), grid.cells.size() * sizeof(GLuint));
+    uploadBuffer(INDICES, GL_R32UI, grid.indices.data(), grid.indices.size() * sizeof(GLuint));
+    uploadBuffer(LIGHTS, GL_RGBA32F, grid.lights.data(), grid.lights.size() * sizeof(glm::vec4));
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+void LightClusters::bindTextures(int firstUnit) const
+{
+    for (int i = 0; i < 3; i++)
+    {
+        glActiveTexture(GL_TEXTURE0 + firstUnit + i);
+        glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+    }
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void LightClusters::applyUniforms(Shader &shader, int firstUnit, glm::vec2 viewportSize,
+                                  float cameraNear, float cameraFar) const
+{
+    shader.setInt("clusterCells", firstUnit + CELLS);
+    shader.setInt("clusterLightIndices", firstUnit + INDICES);
+    shader.setInt("clusterLights", firstUnit + LIGHTS);
+    shader.setVec2("clusterViewport", viewportSize);
+    shader.setFloat("clusterSliceNear", sliceNear);
+    shader.setFloat("clusterSliceFar", sliceFar);
+    shader.setFloat("cameraNear", cameraNear);
+    shader.setFloat("cameraFar", cameraFar);
+}
@@ -0,0 +1,76 @@
+#ifndef LIGHTCLUSTERS_H
+#define LIGHTCLUSTERS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+class Shader;
+
+/**
+ * Clustered forward lighting - point lights binned into a view-space grid
+ * The view frustum is split into TILES_X x TILES_Y screen tiles and SLICES
+ * exponential depth slices. bin() (CPU, no GL, safe to run as a job) writes
+ * per-cluster light lists; the render thread uploads them to texture buffers
+ * and lighting_v4.fs only loops over the lights of its own cluster.
+ */
+class LightClusters
+{
+public:
+    static const int TILES_X = 16;
+    static const int TILES_Y = 9;
+    static const int SLICES = 24;
+    static const int CLUSTER_COUNT = TILES_X * TILES_Y * SLICES;
+
+    // Matches PointLight in lighting_v4.fs
+    struct PointLight
+    {
+        glm::vec3 position;
+        glm::vec3 ambient;
+        glm::vec3 diffuse;
+        glm::vec3 specular;
+        float constant;
+        float linear;
+        float quadratic;
+    };
+
+    // Binned result, ready for upload
+    struct Grid
+    {
+        std::vector<GLuint> cells;      // offset, count per cluster
+        std::vector<GLuint> indices;    // Light indices grouped by cluster
+        std::vector<glm::vec4> lights;  // 4 texels per light (see lighting_v4.fs)
+    };
+
+    /**
+     * @param sliceNear / sliceFar Depth range covered by the exponential slices
+     *        (nearer fragments use slice 0, further ones the last slice)
+     */
+    LightClusters(float sliceNear = 1.0f, float sliceFar = 500.0f);
+    ~LightClusters();
+
+    // Simulation side: bin lights against the camera (fovY in radians)
+    void bin(const std::vector<PointLight> &pointLights, const glm::mat4 &view,
+             float fovY, float aspect, float cameraFar, Grid &out) const;
+
+    // Rendering (requires a current GL context)
+    void initRendering();
+    void upload(const Grid &grid);
+    void bindTextures(int firstUnit) const;
+    void applyUniforms(Shader &shader, int firstUnit, glm::vec2 viewportSize,
+                       float cameraNear, float cameraFar) const;
+
+    // Distance where the light's contribution drops below visible
+    static float lightRadius(const PointLight &light);
+
+private:
+    void uploadBuffer(int buffer, GLenum format, const void *data, size_t bytes);
+
+    float sliceNear, sliceFar;
+
+    // cells / indices / lights: buffer objects and their texture views
+    GLuint buffers[3];
+    GLuint textures[3];
+};
+
+#endif
@@ -0,0 +1,387 @@
+#include "Noise.h"
+#include "JobSystem.h"
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define NOISE_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define NOISE_TARGET(isa)
+#else
+#define NOISE_TARGET(isa) __attribute__((target(isa)))
+#endif
+#else
+#define NOISE_X86 0
+#endif
+
+namespace
+{
+    const int REFERENCE_PERMUTATION[256] = {
+        151, 160, 137, 91, 90, 15, 131, 13, 201, 95, 96, 53, 194, 233, 7, 225, 140, 36, 103, 30, 69, 142,
+        8, 99, 37, 240, 21, 10, 23, 190, 6, 148, 247, 120, 234, 75, 0, 26, 197, 62, 94, 252, 219, 203, 117,
+        35, 11, 32, 57, 177, 33, 88, 237, 149, 56, 87, 174, 20, 125, 136, 171, 168, 68, 175, 74, 165, 71,
+        134, 139, 48, 27, 166, 77, 146, 158, 231, 83, 111, 229, 122, 60, 211, 133, 230, 220, 105, 92, 41,
+        55, 46, 245, 40, 244, 102, 143, 54, 65, 25, 63, 161, 1, 216, 80, 73, 209, 76, 132, 187, 208, 89,
+        18, 169, 200, 196, 135, 130, 116, 188, 159, 86, 164, 100, 109, 198, 173, 186, 3, 64, 52, 217, 226,
+        250, 124, 123, 5, 202, 38, 147, 118, 126, 255, 82, 85, 212, 207, 206, 59, 227, 47, 16, 58, 17, 182,
+        189, 28, 42, 223, 183, 170, 213, 119, 248, 152, 2, 44, 154, 163, 70, 221, 153, 101, 155, 167, 43,
+        172, 9, 129, 22, 39, 253, 19, 98, 108, 110, 79, 113, 224, 232, 178, 185, 112, 104, 218, 246, 97,
+        228, 251, 34, 242, 193, 238, 210, 144, 12, 191, 179, 162, 241, 81, 51, 145, 235, 249, 14, 239, 107,
+        49, 192, 214, 31, 181, 199, 106, 157, 184, 84, 204, 176, 115, 121, 50, 45, 127, 4, 150, 254, 138,
+        236, 205, 93, 222, 114, 67, 29, 24, 72, 243, 141, 128, 195, 78, 66, 215, 61, 156, 180};
+
+    // ===== SCALAR KERNEL =====
+    // The reference every vector kernel reproduces operation for operation
+
+    inline float fade(float t) { return t * t * t * (t * (t * 6 - 15) + 10); }
+    inline float lerp(float t, float a, float b) { return a + t * (b - a); }
+    inline float grad(int hash, float x, float y, float z)
+    {
+        int h = hash & 15;
+        float u = h < 8 ? x : y;
+        float v = h < 4 ? y : h == 12 || h == 14 ? x
+                                                 : z;
+        return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v);
+    }
+
+    float noiseScalar(const int *p, float x, float y, float z)
+    {
+        float fx = std::floor(x), fy = std::floor(y), fz = std::floor(z);
+        int X = (int)fx & 255, Y = (int)fy & 255, Z = (int)fz & 255;
+        x -= fx;
+        y -= fy;
+        z -= fz;
+        float u = fade(x), v = fade(y), w = fade(z);
+        int A = p[X] + Y, AA = p[A] + Z, AB = p[A + 1] + Z, B = p[X + 1] + Y, BA = p[B] + Z, BB = p[B + 1] + Z;
+        return lerp(w, lerp(v, lerp(u, grad(p[AA], x, y, z), grad(p[BA], x - 1, y, z)), lerp(u, grad(p[AB], x, y - 1, z), grad(p[BB], x - 1, y - 1, z))),
+                    lerp(v, lerp(u, grad(p[AA + 1], x, y, z - 1), grad(p[BA + 1], x - 1, y, z - 1)),
+                         lerp(u, grad(p[AB + 1], x, y - 1, z - 1), grad(p[BB + 1], x - 1, y - 1, z - 1))));
+    }
+
+    float fbmScalar(const int *p, float x, float y, float z, int octaves)
+    {
+        float total = 0.0f;
+        float frequency = 1.0f;
+        float amplitude = 1.0f;
+        float maxValue = 0.0f;
+        for (int i = 0; i < octaves; i++)
+        {
+            total += noiseScalar(p, x * frequency, y * frequency, z * frequency) * amplitude;
+            maxValue += amplitude;
+            amplitude *= 0.5f;
+            frequency *= 2.0f;
+        }
+        return total / maxValue;
+    }
+
+    // Samples [begin, count) of a row: the tail the vector kernels leave
+    void fbmRowScalar(const int *p, float *out, int begin, int count, float x, float dx, float y, float z, int octaves)
+    {
+        for (int i = begin; i < count; i++)
+            out[i] = fbmScalar(p, x + (float)i * dx, y, z, octaves);
+    }
+
+#if NOISE_X86
+    // ===== SSE4.1 KERNEL =====
+    // No gather before AVX2: table lookups go through memory lane by lane
+
+    NOISE_TARGET("sse4.1") inline __m128i lookup4(const int *p, __m128i index)
+    {
+        alignas(16) int lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i *>(lanes), index);
+        return _mm_setr_epi32(p[lanes[0]], p[lanes[1]], p[lanes[2]], p[lanes[3]]);
+    }
+
+    NOISE_TARGET("sse4.1") inline __m128 fade4(__m128 t)
+    {
+        __m128 inner = _mm_add_ps(_mm_mul_ps(t, _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f))), _mm_set1_ps(10.0f));
+        return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t, t), t), inner);
+    }
+
+    NOISE_TARGET("sse4.1") inline __m128 lerp4(__m128 t, __m128 a, __m128 b)
+    {
+        return _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a)));
+    }
+
+    NOISE_TARGET("sse4.1") inline __m128 grad4(__m128i hash, __m128 x, __m128 y, __m128 z)
+    {
+        __m128i h = _mm_and_si128(hash, _mm_set1_epi32(15));
+        __m128 below8 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(8)));
+        __m128 below4 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(4)));
+        __m128 is12or14 = _mm_castsi128_ps(_mm_or_si128(_mm_cmpeq_epi32(h, _mm_set1_epi32(12)), _mm_cmpeq_epi32(h, _mm_set1_epi32(14))));
+        __m128 u = _mm_blendv_ps(y, x, below8);
+        __m128 v = _mm_blendv_ps(_mm_blendv_ps(z, x, is12or14), y, below4);
+        // Bits 0 and 1 of h become the sign bits of u and v
+        __m128 signU = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(1)), 31));
+        __m128 signV = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(2)), 30));
+        return _mm_add_ps(_mm_xor_ps(u, signU), _mm_xor_ps(v, signV));
+    }
+
+    NOISE_TARGET("sse4.1") __m128 noise4(const int *p, __m128 x, __m128 y, __m128 z)
+    {
+        const __m128i mask = _mm_set1_epi32(255), one = _mm_set1_epi32(1);
+        const __m128 onef = _mm_set1_ps(1.0f);
+        __m128 fx = _mm_floor_ps(x), fy = _mm_floor_ps(y), fz = _mm_floor_ps(z);
+        __m128i X = _mm_and_si128(_mm_cvttps_epi32(fx), mask);
+        __m128i Y = _mm_and_si128(_mm_cvttps_epi32(fy), mask);
+        __m128i Z = _mm_and_si128(_mm_cvttps_epi32(fz), mask);
+        x = _mm_sub_ps(x, fx);
+        y = _mm_sub_ps(y, fy);
+        z = _mm_sub_ps(z, fz);
+        __m128 u = fade4(x), v = fade4(y), w = fade4(z);
+
+        __m128i A = _mm_add_epi32(lookup4(p, X), Y);
+        __m128i AA = _mm_add_epi32(lookup4(p, A), Z), AB = _mm_add_epi32(lookup4(p, _mm_add_epi32(A, one)), Z);
+        __m128i B = _mm_add_epi32(lookup4(p, _mm_add_epi32(X, one)), Y);
+        __m128i BA = _mm_add_epi32(lookup4(p, B), Z), BB = _mm_add_epi32(lookup4(p, _mm_add_epi32(B, one)), Z);
+
+        __m128 x1 = _mm_sub_ps(x, onef), y1 = _mm_sub_ps(y, onef), z1 = _mm_sub_ps(z, onef);
+        __m128 lowerZ = lerp4(v, lerp4(u, grad4(lookup4(p, AA), x, y, z), grad4(lookup4(p, BA), x1, y, z)),
+                              lerp4(u, grad4(lookup4(p, AB), x, y1, z), grad4(lookup4(p, BB), x1, y1, z)));
+        __m128 upperZ = lerp4(v, lerp4(u, grad4(lookup4(p, _mm_add_epi32(AA, one)), x, y, z1), grad4(lookup4(p, _mm_add_epi32(BA, one)), x1, y, z1)),
+                              lerp4(u, grad4(lookup4(p, _mm_add_epi32(AB, one)), x, y1, z1), grad4(lookup4(p, _mm_add_epi32(BB, one)), x1, y1, z1)));
+        return lerp4(w, lowerZ, upperZ);
+    }
+
+    NOISE_TARGET("sse4.1") int fbmRowSse41(const int *p, float *out, int count, float x, float dx, float y, float z, int octaves)
+    {
+        float maxValue = 0.0f, amplitude = 1.0f;
+        for (int o = 0; o < octaves; o++, amplitude *= 0.5f)
+            maxValue += amplitude;
+
+        int i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 index = _mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32(i), _mm_setr_epi32(0, 1, 2, 3)));
+            __m128 px = _mm_add_ps(_mm_set1_ps(x), _mm_mul_ps(index, _mm_set1_ps(dx)));
+            __m128 total = _mm_setzero_ps();
+            float frequency = 1.0f;
+            amplitude = 1.0f;
+            for (int o = 0; o < octaves; o++)
+            {
+                __m128 f = _mm_set1_ps(frequency);
+                __m128 n = noise4(p, _mm_mul_ps(px, f), _mm_set1_ps(y * frequency), _mm_set1_ps(z * frequency));
+                total = _mm_add_ps(total, _mm_mul_ps(n, _mm_set1_ps(amplitude)));
+                amplitude *= 0.5f;
+                frequency *= 2.0f;
+            }
+            _mm_storeu_ps(out + i, _mm_div_ps(total, _mm_set1_ps(maxValue)));
+        }
+        return i;
+    }
+
+    // ===== AVX2 KERNEL =====
+
+    NOISE_TARGET("avx2") inline __m256i lookup8(const int *p, __m256i index)
+    {
+        return _mm256_i32gather_epi32(p, index, 4);
+    }
+
+    NOISE_TARGET("avx2") inline __m256 fade8(__m256 t)
+    {
+        __m256 inner = _mm256_add_ps(_mm256_mul_ps(t, _mm256_sub_ps(_mm256_mul_ps(t, _mm256_set1_ps(6.0f)), _mm256_set1_ps(15.0f))), _mm256_set1_ps(10.0f));
+        return _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(t, t), t), inner);
+    }
+
+    NOISE_TARGET("avx2") inline __m256 lerp8(__m256 t, __m256 a, __m256 b)
+    {
+        return _mm256_add_ps(a, _mm256_mul_ps(t, _mm256_sub_ps(b, a)));
+    }
+
+    NOISE_TARGET("avx2") inline __m256 grad8(__m256i hash, __m256 x, __m256 y, __m256 z)
+    {
+        __m256i h = _mm256_and_si256(hash, _mm256_set1_epi32(15));
+        __m256 below8 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(8), h));
+        __m256 below4 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(4), h));
+        __m256 is12or14 = _mm256_castsi256_ps(_mm256_or_si256(_mm256_cmpeq_epi32(h, _mm256_set1_epi32(12)), _mm256_cmpeq_epi32(h, _mm256_set1_epi32(14))));
+        __m256 u = _mm256_blendv_ps(y, x, below8);
+        __m256 v = _mm256_blendv_ps(_mm256_blendv_ps(z, x, is12or14), y, below4);
+        __m256 signU = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(1)), 31));
+        __m256 signV = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(2)), 30));
+        return _mm256_add_ps(_mm256_xor_ps(u, signU), _mm256_xor_ps(v, signV));
+    }
+
+    NOISE_TARGET("avx2") __m256 noise8(const int *p, __m256 x, __m256 y, __m256 z)
+    {
+        const __m256i mask = _mm256_set1_epi32(255), one = _mm256_set1_epi32(1);
+        const __m256 onef = _mm256_set1_ps(1.0f);
+        __m256 fx = _mm256_floor_ps(x), fy = _mm256_floor_ps(y), fz = _mm256_floor_ps(z);
+        __m256i X = _mm256_and_si256(_mm256_cvttps_epi32(fx), mask);
+        __m256i Y = _mm256_and_si256(_mm256_cvttps_epi32(fy), mask);
+        __m256i Z = _mm256_and_si256(_mm256_cvttps_epi32(fz), mask);
+        x = _mm256_sub_ps(x, fx);
+        y = _mm256_sub_ps(y, fy);
+        z = _mm256_sub_ps(z, fz);
+        __m256 u = fade8(x), v = fade8(y), w = fade8(z);
+
+        __m256i A = _mm256_add_epi32(lookup8(p, X), Y);
+        __m256i AA = _mm256_add_epi32(lookup8(p, A), Z), AB = _mm256_add_epi32(lookup8(p, _mm256_add_epi32(A, one)), Z);
+        __m256i B = _mm256_add_epi32(lookup8(p, _mm256_add_epi32(X, one)), Y);
+        __m256i BA = _mm256_add_epi32(lookup8(p, B), Z), BB = _mm256_add_epi32(lookup8(p, _mm256_add_epi32(B, one)), Z);
+
+        __m256 x1 = _mm256_sub_ps(x, onef), y1 = _mm256_sub_ps(y, onef), z1 = _mm256_sub_ps(z, onef);
+        __m256 lowerZ = lerp8(v, lerp8(u, grad8(lookup8(p, AA), x, y, z), grad8(lookup8(p, BA), x1, y, z)),
+                              lerp8(u, grad8(lookup8(p, AB), x, y1, z), grad8(lookup8(p, BB), x1, y1, z)));
+        __m256 upperZ = lerp8(v, lerp8(u, grad8(lookup8(p, _mm256_add_epi32(AA, one)), x, y, z1), grad8(lookup8(p, _mm256_add_epi32(BA, one)), x1, y, z1)),
+                              lerp8(u, grad8(lookup8(p, _mm256_add_epi32(AB, one)), x, y1, z1), grad8(lookup8(p, _mm256_add_epi32(BB, one)), x1, y1, z1)));
+        return lerp8(w, lowerZ, upperZ);
+    }
+
+    NOISE_TARGET("avx2") int fbmRowAvx2(const int *p, float *out, int count, float x, float dx, float y, float z, int octaves)
+    {
+        float maxValue = 0.0f, amplitude = 1.0f;
+        for (int o = 0; o < octaves; o++, amplitude *= 0.5f)
+            maxValue += amplitude;
+
+        int i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256 index = _mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_set1_epi32(i), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+            __m256 px = _mm256_add_ps(_mm256_set1_ps(x), _mm256_mul_ps(index, _mm256_set1_ps(dx)));
+            __m256 total = _mm256_setzero_ps();
+            float frequency = 1.0f;
+            amplitude = 1.0f;
+            for (int o = 0; o < octaves; o++)
+            {
+                __m256 f = _mm256_set1_ps(frequency);
+                __m256 n = noise8(p, _mm256_mul_ps(px, f), _mm256_set1_ps(y * frequency), _mm256_set1_ps(z * frequency));
+                total = _mm256_add_ps(total, _mm256_mul_ps(n, _mm256_set1_ps(amplitude)));
+                amplitude *= 0.5f;
+                frequency *= 2.0f;
+            }
+            _mm256_storeu_ps(out + i, _mm256_div_ps(total, _mm256_set1_ps(maxValue)));
+        }
+        return i;
+    }
+
+    // ===== CPU DETECTION =====
+
+    bool cpuHasSse41()
+    {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] & (1 << 19)) != 0;
+#else
+        return __builtin_cpu_supports("sse4.1");
+#endif
+    }
+
+    bool cpuHasAvx2()
+    {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return false;
+        __cpuid(info, 1);
+        const int osxsave = 1 << 27, avx = 1 << 28;
+        if ((info[2] & (osxsave | avx)) != (osxsave | avx) || (_xgetbv(0) & 6) != 6) // OS saves YMM state
+            return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif
+}
+
+PerlinNoise::PerlinNoise(unsigned int seed)
+    : kernel(bestKernel())
+{
+    int table[256];
+    for (int i = 0; i < 256; i++)
+        table[i] = REFERENCE_PERMUTATION[i];
+
+    // Fisher-Yates with xorshift32: the same table for a seed on every platform
+    if (seed != 0)
+    {
+        unsigned int state = seed;
+        for (int i = 255; i > 0; i--)
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            int j = (int)(state % (unsigned int)(i + 1));
+            int swap = table[i];
+            table[i] = table[j];
+            table[j] = swap;
+        }
+    }
+
+    for (int i = 0; i < 256; i++)
+        perm[256 + i] = perm[i] = table[i];
+}
+
+float PerlinNoise::noise(float x, float y, float z) const
+{
+    return noiseScalar(perm, x, y, z);
+}
+
+float PerlinNoise::fbm(float x, float y, float z, int octaves) const
+{
+    return fbmScalar(perm, x, y, z, octaves);
+}
+
+void PerlinNoise::fbmRow(float *out, int count, float x, float dx, float y, float z, int octaves) const
+{
+    int done = 0;
+#if NOISE_X86
+    if (kernel == KERNEL_AVX2)
+        done = fbmRowAvx2(perm, out, count, x, dx, y, z, octaves);
+    else if (kernel == KERNEL_SSE41)
+        done = fbmRowSse41(perm, out, count, x, dx, y, z, octaves);
+#endif
+    fbmRowScalar(perm, out, done, count, x, dx, y, z, octaves);
+}
+
+void PerlinNoise::fbmBlock(float *out, int width, int height, int depth, glm::vec3 origin, glm::vec3 step,
+                           int octaves, JobSystem *jobs) const
+{
+    auto rows = [&](size_t begin, size_t end)
+    {
+        for (size_t row = begin; row < end; row++)
+        {
+            float y = origin.y + (float)(row % height) * step.y;
+            float z = origin.z + (float)(row / height) * step.z;
+            fbmRow(out + row * width, width, origin.x, step.x, y, z, octaves);
+        }
+    };
+
+    size_t rowCount = (size_t)height * depth;
+    if (jobs)
+        jobs->parallel_for(rowCount, 0, rows);
+    else
+        rows(0, rowCount);
+}
+
+void PerlinNoise::setKernel(Kernel requested)
+{
+    kernel = requested < bestKernel() ? requested : bestKernel();
+}
+
+PerlinNoise::Kernel PerlinNoise::bestKernel()
+{
+#if NOISE_X86
+    static const Kernel best = cpuHasAvx2() ? KERNEL_AVX2 : cpuHasSse41() ? KERNEL_SSE41
+                                                                            : KERNEL_SCALAR;
+    return best;
+#else
+    return KERNEL_SCALAR;
+#endif
+}
+
+const char *PerlinNoise::kernelName(Kernel kernel)
+{
+    switch (kernel)
+    {
+    case KERNEL_AVX2:
+        return "AVX2";
+    case KERNEL_SSE41:
+        return "SSE4.1";
+    default:
+        return "scalar";
+    }
+}
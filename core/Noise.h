@@ -0,0 +1,57 @@
+#ifndef NOISE_H
+#define NOISE_H
+
+#include <glm/glm.hpp>
+
+class JobSystem;
+
+/**
+ * Improved Perlin noise and FBM over a seeded permutation table
+ * Single samples for scattered lookups, and row/block calls that evaluate
+ * many samples at once with SSE4.1 or AVX2 when the CPU has them (picked at
+ * runtime). Every kernel performs the same float operations in the same
+ * order, so results are bit-identical whichever one runs. Queries are const
+ * and safe from any thread.
+ */
+class PerlinNoise
+{
+public:
+    enum Kernel
+    {
+        KERNEL_SCALAR,
+        KERNEL_SSE41, // 4 samples per step
+        KERNEL_AVX2   // 8 samples per step, table lookups gathered
+    };
+
+    // Seed 0 is Ken Perlin's reference table; others shuffle it deterministically
+    explicit PerlinNoise(unsigned int seed = 0);
+
+    float noise(float x, float y, float z) const;             // -1..1
+    float fbm(float x, float y, float z, int octaves) const;  // Doubling frequency, halving amplitude
+
+    // out[i] = fbm(x + i * dx, y, z)
+    void fbmRow(float *out, int count, float x, float dx, float y, float z, int octaves) const;
+
+    /**
+     * out[(k * height + j) * width + i] = fbm(origin + step * (i, j, k))
+     * A depth of 1 is a 2D image at origin.z. With jobs, rows are spread
+     * over its threads (so call from its owning thread or a job).
+     */
+    void fbmBlock(float *out, int width, int height, int depth, glm::vec3 origin, glm::vec3 step,
+                  int octaves, JobSystem *jobs = nullptr) const;
+
+    // The 256-entry table twice over (512 entries)
+    const int *getPermutation() const { return perm; }
+
+    Kernel getKernel() const { return kernel; }
+    // Clamped to the best kernel this CPU supports
+    void setKernel(Kernel requested);
+    static Kernel bestKernel();
+    static const char *kernelName(Kernel kernel);
+
+private:
+    int perm[512];
+    Kernel kernel;
+};
+
+#endif
@@ -0,0 +1,149 @@
+#include "OcclusionQueries.h"
+#include "RenderQueue.h"
+#include "../Shader.h"
+
+OcclusionQueries::OcclusionQueries()
+    : current(0), skipped(0), tested(0), VAO(0), VBO(0), EBO(0)
+{
+}
+
+OcclusionQueries::~OcclusionQueries()
+{
+    if (VAO != 0)
+    {
+        glDeleteQueries((GLsizei)boxes.size(), queries[0].data());
+        glDeleteQueries((GLsizei)boxes.size(), queries[1].data());
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+    }
+}
+
+int OcclusionQueries::add(glm::vec3 boxMin, glm::vec3 boxMax)
+{
+    boxes.push_back({boxMin, boxMax});
+    return (int)boxes.size() - 1;
+}
+
+void OcclusionQueries::initRendering()
+{
+    for (int set = 0; set < 2; set++)
+    {
+        queries[set].resize(boxes.size());
+        issued[set].assign(boxes.size(), 0);
+        ready.assign(boxes.size(), 0);
+        if (!boxes.empty())
+            glGenQueries((GLsizei)boxes.size(), queries[set].data());
+    }
+
+    // Unit cube; occlusion_box.vs stretches it between boxMin and boxMax
+    const float corners[8][3] = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0},
+                                 {0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}};
+    const GLuint faces[36] = {0, 1, 2, 0, 2, 3, 4, 6, 5, 4, 7, 6,
+                              0, 4, 5, 0, 5, 1, 3, 2, 6, 3, 6, 7,
+                              0, 3, 7, 0, 7, 4, 1, 5, 6, 1, 6, 2};
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(faces), faces, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
+    glBindVertexArray(0);
+}
+
+void OcclusionQueries::beginFrame()
+{
+    int previous = current ^ 1;
+    for (size_t i = 0; i < boxes.size(); i++)
+    {
+        GLuint available = GL_FALSE;
+        if (issued[previous][i])
+            glGetQueryObjectuiv(queries[previous][i], GL_QUERY_RESULT_AVAILABLE, &available);
+        ready[i] = available ? 1 : 0;
+    }
+}
+
+void OcclusionQueries::beginConditional(int id) const
+{
+    // The result is back, so waiting on it costs nothing and every pass
+    // this frame sees the same answer
+    if (ready[id])
+        glBeginConditionalRender(queries[current ^ 1][id], GL_QUERY_WAIT);
+}
+
+void OcclusionQueries::endConditional(int id) const
+{
+    if (ready[id])
+        glEndConditionalRender();
+}
+
+void OcclusionQueries::issue(Shader &boxShader, const glm::mat4 &viewProjection, glm::vec3 viewPos, float margin)
+{
+    // This set was tested two frames ago and drawn against last frame
+    collect(current);
+
+    Frustum frustum(viewProjection);
+    boxShader.use();
+    boxShader.setMat4("viewProjection", viewProjection);
+
+    // Depth test only: nothing written, both sides rasterised
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_FALSE);
+    glDisable(GL_CULL_FACE);
+    glBindVertexArray(VAO);
+
+    for (size_t i = 0; i < boxes.size(); i++)
+    {
+        const Box &box = boxes[i];
+        issued[current][i] = 0;
+        if (!frustum.containsBox(box.min, box.max))
+            continue;
+        // Near-plane clipping would make a box around the camera look hidden
+        glm::vec3 lo = box.min - margin, hi = box.max + margin;
+        if (viewPos.x > lo.x && viewPos.y > lo.y && viewPos.z > lo.z && viewPos.x < hi.x && viewPos.y < hi.y && viewPos.z < hi.z)
+            continue;
+
+        boxShader.setVec3("boxMin", box.min);
+        boxShader.setVec3("boxMax", box.max);
+        glBeginQuery(GL_ANY_SAMPLES_PASSED, queries[current][i]);
+        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+        glEndQuery(GL_ANY_SAMPLES_PASSED);
+        issued[current][i] = 1;
+    }
+
+    glBindVertexArray(0);
+    glDepthMask(GL_TRUE);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+    current ^= 1;
+}
+
+void OcclusionQueries::collect(int set)
+{
+    int hidden = 0, count = 0;
+    for (size_t i = 0; i < boxes.size(); i++)
+    {
+        if (!issued[set][i])
+            continue;
+
+        // Never wait: a frame with results still in flight is not reported
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(queries[set][i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            return;
+
+        GLuint anySamples = GL_FALSE;
+        glGetQueryObjectuiv(queries[set][i], GL_QUERY_RESULT, &anySamples);
+        count++;
+        if (!anySamples)
+            hidden++;
+    }
+
+    skipped = hidden;
+    tested = count;
+}
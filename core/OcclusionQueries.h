@@ -0,0 +1,69 @@
+#ifndef OCCLUSIONQUERIES_H
+#define OCCLUSIONQUERIES_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+class Shader;
+
+/**
+ * Hardware occlusion culling for objects usually hidden behind big occluders
+ * Each registered object (a world-space box) gets two GL_ANY_SAMPLES_PASSED
+ * queries used in alternate frames. issue() draws the boxes of the objects in
+ * view against the finished depth buffer. At the start of the next frame,
+ * beginFrame() polls which of those results are already back; only those
+ * objects are drawn under conditional rendering (the GPU drops them when the
+ * box was hidden), the rest draw unconditionally. Deciding once per frame
+ * keeps every pass of the frame (depth pre-pass, then GL_EQUAL shading) in
+ * agreement, and nothing ever waits. A hidden object that comes into view
+ * therefore appears one frame late. Render thread only, except add().
+ */
+class OcclusionQueries
+{
+public:
+    OcclusionQueries();
+    ~OcclusionQueries();
+
+    // Scene setup: register an object, returns its id for DrawItem::occlusionId
+    int add(glm::vec3 boxMin, glm::vec3 boxMax);
+
+    // Rendering (requires a current GL context)
+    void initRendering();
+
+    // Before the frame's first pass: latch which of last frame's results are back
+    void beginFrame();
+
+    // Wrap an object's draws; objects without a result at beginFrame() draw as usual
+    void beginConditional(int id) const;
+    void endConditional(int id) const;
+
+    // Test the boxes in view against the bound depth buffer (boxShader:
+    // occlusion_box.vs). Boxes the camera is inside are not tested
+    void issue(Shader &boxShader, const glm::mat4 &viewProjection, glm::vec3 viewPos, float margin);
+
+    // From the newest frame whose results are all back: objects whose draws
+    // the GPU skipped, out of those tested
+    int getSkippedCount() const { return skipped; }
+    int getTestedCount() const { return tested; }
+    size_t size() const { return boxes.size(); }
+
+private:
+    void collect(int set);
+
+    struct Box
+    {
+        glm::vec3 min, max;
+    };
+
+    std::vector<Box> boxes;
+    std::vector<GLuint> queries[2]; // Per frame parity, one per object
+    std::vector<char> issued[2];
+    std::vector<char> ready; // Draw set results available at beginFrame()
+    int current; // Set issue() writes; draws use the other one
+
+    int skipped, tested;
+    GLuint VAO, VBO, EBO;
+};
+
+#endif
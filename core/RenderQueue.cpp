@@ -0,0 +1,123 @@
+#include "RenderQueue.h"
+#include "JobSystem.h"
+#include "OcclusionQueries.h"
+#include "Mesh.h"
+#include "../models/Texture.h"
+#include "../Shader.h"
+#include <algorithm>
+#include <cmath>
+
+// ===== FRUSTUM =====
+
+Frustum::Frustum(const glm::mat4 &m)
+{
+    // Gribb/Hartmann: planes are row 3 +/- rows 0..2 (glm is column-major)
+    for (int i = 0; i < 3; i++)
+    {
+        for (int side = 0; side < 2; side++)
+        {
+            float sign = side == 0 ? 1.0f : -1.0f;
+            float *plane = planes[i * 2 + side];
+            for (int c = 0; c < 4; c++)
+                plane[c] = m[c][3] + sign * m[c][i];
+
+            float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+            for (int c = 0; c < 4; c++)
+                plane[c] /= length;
+        }
+    }
+}
+
+bool Frustum::containsSphere(glm::vec3 center, float radius) const
+{
+    for (int i = 0; i < 6; i++)
+    {
+        const float *p = planes[i];
+        if (p[0] * center.x + p[1] * center.y + p[2] * center.z + p[3] < -radius)
+            return false;
+    }
+    return true;
+}
+
+bool Frustum::containsBox(glm::vec3 boxMin, glm::vec3 boxMax) const
+{
+    for (int i = 0; i < 6; i++)
+    {
+        const float *p = planes[i];
+        // Corner furthest along the plane normal
+        float x = p[0] >= 0.0f ? boxMax.x : boxMin.x;
+        float y = p[1] >= 0.0f ? boxMax.y : boxMin.y;
+        float z = p[2] >= 0.0f ? boxMax.z : boxMin.z;
+        if (p[0] * x + p[1] * y + p[2] * z + p[3] < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+// ===== RENDER QUEUE =====
+
+RenderQueue::RenderQueue(int threadCount)
+    : buckets(std::max(1, threadCount))
+{
+}
+
+void RenderQueue::clear()
+{
+    for (auto &bucket : buckets)
+        bucket.clear();
+    items.clear();
+}
+
+void RenderQueue::push(const DrawItem &item)
+{
+    buckets[JobSystem::currentThreadIndex()].push_back(item);
+}
+
+void RenderQueue::finish()
+{
+    for (const auto &bucket : buckets)
+        items.insert(items.end(), bucket.begin(), bucket.end());
+
+    std::sort(items.begin(), items.end(), [](const DrawItem &a, const DrawItem &b)
+              {
+                  if (a.windowLights != b.windowLights)
+                      return b.windowLights;
+                  if (a.texture != b.texture)
+                      return a.texture < b.texture;
+                  return a.mesh < b.mesh; });
+}
+
+void RenderQueue::submit(Shader &shader, Shader &windowShader, const OcclusionQueries *occlusion) const
+{
+    Texture *boundTexture = nullptr;
+    Shader *current = &shader;
+
+    for (const DrawItem &item : items)
+    {
+        Shader *wanted = item.windowLights ? &windowShader : &shader;
+        if (wanted != current)
+        {
+            wanted->use();
+            current = wanted;
+        }
+        if (item.texture && item.texture != boundTexture)
+        {
+            item.texture->bind(0);
+            boundTexture = item.texture;
+        }
+        current->setMat4("model", item.model);
+        if (occlusion && item.occlusionId >= 0)
+        {
+            occlusion->beginConditional(item.occlusionId);
+            item.mesh->draw();
+            occlusion->endConditional(item.occlusionId);
+        }
+        else
+        {
+            item.mesh->draw();
+        }
+    }
+
+    if (current != &shader)
+        shader.use();
+}
@@ -0,0 +1,63 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include <glm/glm.hpp>
+#include <vector>
+
+class Mesh;
+class OcclusionQueries;
+class Shader;
+class Texture;
+
+/**
+ * View frustum as six normalised planes (extracted from a view-projection
+ * matrix); used to cull bounding spheres and boxes before drawing
+ */
+class Frustum
+{
+public:
+    explicit Frustum(const glm::mat4 &viewProjection);
+
+    bool containsSphere(glm::vec3 center, float radius) const;
+    bool containsBox(glm::vec3 boxMin, glm::vec3 boxMax) const;
+
+private:
+    float planes[6][4]; // a, b, c, d with (a, b, c) pointing inside
+};
+
+// One prepared draw: everything the GL thread needs, nothing it has to compute
+struct DrawItem
+{
+    Mesh *mesh;
+    Texture *texture;
+    glm::mat4 model;
+    bool windowLights;
+    int occlusionId; // OcclusionQueries object, -1 = always drawn
+};
+
+/**
+ * Draw list filled by jobs and submitted by the GL thread
+ * push() appends to the calling job thread's own bucket (no locking);
+ * finish() merges the buckets and sorts by program, texture, then mesh, so
+ * submit() switches programs and binds textures as rarely as possible.
+ */
+class RenderQueue
+{
+public:
+    explicit RenderQueue(int threadCount);
+
+    void clear();
+    void push(const DrawItem &item);
+    void finish();
+    // windowLights items use windowShader; items with an occlusionId draw
+    // conditionally on its last query when occlusion is given
+    void submit(Shader &shader, Shader &windowShader, const OcclusionQueries *occlusion = nullptr) const;
+
+    size_t size() const { return items.size(); }
+
+private:
+    std::vector<std::vector<DrawItem>> buckets; // One per job system thread
+    std::vector<DrawItem> items;
+};
+
+#endif
@@ -0,0 +1,235 @@
+#include "ShadowCascades.h"
+#include "../Shader.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+namespace
+{
+    // Room behind each slice (towards the sun) for casters outside it:
+    // background buildings are up to 50 m tall
+    const float CASTER_MARGIN = 150.0f;
+    const float BIAS_TEXELS = 2.0f;
+
+    // Static cache: boxes are this much larger than their slice, and are
+    // refitted when the sun turns further than the threshold (the sun moves
+    // about 7 degrees a second at the default day speed, none when paused).
+    // The threshold is for the first cascade; the others scale it by their
+    // texel size, so the lag is about the same number of texels in each
+    const float CACHE_PADDING = 1.2f;
+    const float SUN_CHANGE_DEGREES = 0.5f;
+}
+
+ShadowCascades::ShadowCascades(int res, float distance, float lambda)
+    : resolution(res), shadowDistance(distance), splitLambda(lambda),
+      fbo(0), staticFbo(0), depthArray(0), staticArray(0)
+{
+    for (int i = 0; i < COUNT; i++)
+    {
+        cached[i].valid = false;
+        cached[i].version = 0;
+        renderedVersion[i] = 0;
+        hasRendered[i] = false;
+    }
+}
+
+ShadowCascades::~ShadowCascades()
+{
+    if (fbo != 0)
+    {
+        glDeleteFramebuffers(1, &fbo);
+        glDeleteFramebuffers(1, &staticFbo);
+        glDeleteTextures(1, &depthArray);
+        glDeleteTextures(1, &staticArray);
+    }
+}
+
+void ShadowCascades::fit(const glm::mat4 &view, float fovY, float aspect, float cameraNear,
+                         glm::vec3 toLight, Frame &out)
+{
+    const glm::mat4 inverseView = glm::inverse(view);
+    // View-space distance of a slice corner from the axis, per unit depth
+    const float tanY = std::tan(fovY * 0.5f);
+    const float cornerSlope = std::sqrt(1.0f + aspect * aspect) * tanY;
+
+    glm::vec3 up = std::abs(toLight.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+
+    float sliceFar[COUNT];
+    float radius[COUNT];
+    glm::vec3 center[COUNT];
+    float sliceNear = cameraNear;
+    for (int i = 0; i < COUNT; i++)
+    {
+        // Practical split scheme: logarithmic near the camera, uniform further out
+        float t = static_cast<float>(i + 1) / COUNT;
+        float logSplit = cameraNear * std::pow(shadowDistance / cameraNear, t);
+        float uniformSplit = cameraNear + (shadowDistance - cameraNear) * t;
+        sliceFar[i] = splitLambda * logSplit + (1.0f - splitLambda) * uniformSplit;
+
+        // Smallest sphere around the slice, centred on the view axis; its size
+        // does not change as the camera turns, so neither does texel size
+        float centerDepth = 0.5f * (sliceNear + sliceFar[i]) * (1.0f + cornerSlope * cornerSlope);
+        if (centerDepth >= sliceFar[i])
+        {
+            centerDepth = sliceFar[i];
+            radius[i] = sliceFar[i] * cornerSlope;
+        }
+        else
+        {
+            float dz = sliceFar[i] - centerDepth;
+            float corner = sliceFar[i] * cornerSlope;
+            radius[i] = std::sqrt(dz * dz + corner * corner);
+        }
+        center[i] = glm::vec3(inverseView * glm::vec4(0.0f, 0.0f, -centerDepth, 1.0f));
+
+        sliceNear = sliceFar[i];
+    }
+
+    // A slice that left its box (or a box far too coarse after a zoom) is
+    // refitted now. A sun turn can wait: only the cascade furthest past its
+    // threshold is refitted, and only when nothing else is, so a moving sun
+    // redraws at most one static layer per frame
+    bool refit[COUNT];
+    bool anyRefit = false;
+    int sunRefit = -1;
+    float sunOverdue = 1.0f;
+    for (int i = 0; i < COUNT; i++)
+    {
+        const CachedFit &fitted = cached[i];
+        refit[i] = !fitted.valid ||
+                   glm::length(center[i] - fitted.center) + radius[i] > fitted.radius ||
+                   radius[i] * CACHE_PADDING * 2.0f <= fitted.radius;
+        anyRefit = anyRefit || refit[i];
+        if (refit[i])
+            continue;
+
+        float turned = std::acos(std::min(glm::dot(toLight, fitted.toLight), 1.0f));
+        float threshold = glm::radians(SUN_CHANGE_DEGREES) * radius[i] / radius[0];
+        if (turned / threshold > sunOverdue)
+        {
+            sunOverdue = turned / threshold;
+            sunRefit = i;
+        }
+    }
+    if (!anyRefit && sunRefit >= 0)
+        refit[sunRefit] = true;
+
+    for (int i = 0; i < COUNT; i++)
+    {
+        CachedFit &fitted = cached[i];
+        if (refit[i])
+        {
+            float boxRadius = std::ceil(radius[i] * CACHE_PADDING * 16.0f) / 16.0f;
+            float depthRange = 2.0f * boxRadius + CASTER_MARGIN;
+            glm::mat4 lightView = glm::lookAt(center[i] + toLight * (boxRadius + CASTER_MARGIN), center[i], up);
+            glm::mat4 lightProjection = glm::ortho(-boxRadius, boxRadius, -boxRadius, boxRadius, 0.0f, depthRange);
+
+            // Texel snapping: shift the projection so the world origin lands on a
+            // texel corner, which keeps every world point on the same texel
+            glm::vec4 origin = lightProjection * lightView * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+            float texelsPerUnit = resolution * 0.5f;
+            glm::vec2 originTexels = glm::vec2(origin.x, origin.y) * texelsPerUnit;
+            glm::vec2 offset = (glm::floor(originTexels + 0.5f) - originTexels) / texelsPerUnit;
+            lightProjection[3][0] += offset.x;
+            lightProjection[3][1] += offset.y;
+
+            fitted.valid = true;
+            fitted.center = center[i];
+            fitted.toLight = toLight;
+            fitted.radius = boxRadius;
+            fitted.lightSpace = lightProjection * lightView;
+            fitted.depthRange = depthRange;
+            fitted.version++;
+        }
+
+        out.lightSpace[i] = fitted.lightSpace;
+        out.splitDepth[i] = sliceFar[i];
+        out.depthBias[i] = BIAS_TEXELS * (2.0f * fitted.radius / resolution) / fitted.depthRange;
+        out.staticVersion[i] = fitted.version;
+    }
+}
+
+void ShadowCascades::initRendering()
+{
+    GLuint *arrays[2] = {&depthArray, &staticArray};
+    GLuint *fbos[2] = {&fbo, &staticFbo};
+    for (int i = 0; i < 2; i++)
+    {
+        glGenTextures(1, arrays[i]);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, *arrays[i]);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, resolution, resolution, COUNT, 0,
+                     GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+        // The sampled array compares in hardware (sampler2DArrayShadow): each
+        // tap returns the bilinear-filtered fraction of lit texels
+        GLenum filter = arrays[i] == &depthArray ? GL_LINEAR : GL_NEAREST;
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, filter);
+        if (arrays[i] == &depthArray)
+        {
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        }
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+        float borderColor[] = {1.0f, 1.0f, 1.0f, 1.0f};
+        glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, borderColor);
+
+        glGenFramebuffers(1, fbos[i]);
+        glBindFramebuffer(GL_FRAMEBUFFER, *fbos[i]);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, *arrays[i], 0, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "ERROR::FRAMEBUFFER:: Shadow cascade framebuffer is not complete!" << std::endl;
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+bool ShadowCascades::beginStaticCascade(int cascade, const Frame &frame)
+{
+    if (hasRendered[cascade] && renderedVersion[cascade] == frame.staticVersion[cascade])
+        return false;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, staticFbo);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticArray, 0, cascade);
+    glViewport(0, 0, resolution, resolution);
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    renderedVersion[cascade] = frame.staticVersion[cascade];
+    hasRendered[cascade] = true;
+    return true;
+}
+
+void ShadowCascades::beginCascade(int cascade) const
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, staticFbo);
+    glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticArray, 0, cascade);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
+    glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthArray, 0, cascade);
+    glBlitFramebuffer(0, 0, resolution, resolution, 0, 0, resolution, resolution, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, resolution, resolution);
+}
+
+void ShadowCascades::bindTexture(int unit) const
+{
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, depthArray);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void ShadowCascades::applyUniforms(Shader &shader, int unit, const Frame &frame) const
+{
+    shader.setInt("shadowMap", unit);
+    for (int i = 0; i < COUNT; i++)
+    {
+        std::string index = "[" + std::to_string(i) + "]";
+        shader.setMat4("cascadeMatrices" + index, frame.lightSpace[i]);
+        shader.setFloat("cascadeSplits" + index, frame.splitDepth[i]);
+        shader.setFloat("cascadeBias" + index, frame.depthBias[i]);
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef SHADOWCASCADES_H
+#define SHADOWCASCADES_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+class Shader;
+
+/**
+ * Cascaded shadow maps for the sun - one depth layer per view-depth slice
+ * fit() (CPU, no GL, safe to run on the simulation thread) splits the first
+ * shadowDistance units of the camera frustum into COUNT slices and fits a
+ * light-space ortho box around each slice's bounding sphere. The box is
+ * snapped to whole shadow texels so shadow edges do not shimmer as the
+ * camera moves. The render thread draws each cascade into one layer of a
+ * depth texture array; shadow.glsl picks the layer by view depth.
+ *
+ * Static casters are cached: a fitted box is padded and kept while its slice
+ * stays inside it and the sun has not turned past a threshold (scaled by the
+ * cascade's texel size; sun refits are staggered, one cascade per frame).
+ * Only when a cascade is refitted (its staticVersion changes) are the static
+ * casters redrawn into a cache layer; every frame copies that layer and adds
+ * the dynamic casters on top.
+ */
+class ShadowCascades
+{
+public:
+    static const int COUNT = 4; // Must match SHADOW_CASCADES in shadow.glsl
+
+    // Per-frame result, ready for the shadow pass and lighting uniforms
+    struct Frame
+    {
+        glm::mat4 lightSpace[COUNT]; // World to light clip space
+        float splitDepth[COUNT];     // Far view depth covered by each cascade
+        float depthBias[COUNT];      // About two texels, in that cascade's depth units
+        unsigned int staticVersion[COUNT]; // Changes whenever the static cache is stale
+    };
+
+    /**
+     * @param resolution Texels per side of every cascade layer
+     * @param shadowDistance View depth beyond which nothing is shadowed
+     * @param splitLambda Blend of logarithmic (1) and uniform (0) splits
+     */
+    ShadowCascades(int resolution = 1024, float shadowDistance = 250.0f, float splitLambda = 0.8f);
+    ~ShadowCascades();
+
+    // Simulation side: toLight points from the scene towards the sun (fovY in radians)
+    void fit(const glm::mat4 &view, float fovY, float aspect, float cameraNear,
+             glm::vec3 toLight, Frame &out);
+
+    // Rendering (requires a current GL context)
+    void initRendering();
+    // Binds and clears the cache layer if it is older than frame's version;
+    // false when the cache is current (nothing to draw)
+    bool beginStaticCascade(int cascade, const Frame &frame);
+    // Copies the cache layer into the shadow layer and binds it for the dynamic casters
+    void beginCascade(int cascade) const;
+    void bindTexture(int unit) const;
+    void applyUniforms(Shader &shader, int unit, const Frame &frame) const;
+
+    int getResolution() const { return resolution; }
+
+private:
+    // Simulation side: box each cascade was last fitted to
+    struct CachedFit
+    {
+        bool valid;
+        glm::vec3 center;
+        glm::vec3 toLight;
+        float radius; // Padded
+        glm::mat4 lightSpace;
+        float depthRange;
+        unsigned int version;
+    };
+
+    int resolution;
+    float shadowDistance;
+    float splitLambda;
+    CachedFit cached[COUNT];
+
+    // Render side
+    GLuint fbo, staticFbo;
+    GLuint depthArray, staticArray;
+    unsigned int renderedVersion[COUNT];
+    bool hasRendered[COUNT];
+};
+
+#endif
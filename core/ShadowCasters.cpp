@@ -0,0 +1,117 @@
+#include "ShadowCasters.h"
+#include "Mesh.h"
+#include "RenderQueue.h"
+#include "../Shader.h"
+#include <algorithm>
+#include <iostream>
+
+ShadowCasters::ShadowCasters()
+    : VAO(0), VBO(0), EBO(0)
+{
+}
+
+ShadowCasters::~ShadowCasters()
+{
+    if (VAO != 0)
+    {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+    }
+}
+
+void ShadowCasters::add(const Mesh *mesh, const glm::mat4 &model)
+{
+    if (!mesh || !mesh->castsShadow || mesh->vertices.empty())
+        return;
+
+    auto found = ranges.find(mesh);
+    if (found == ranges.end())
+    {
+        Range range;
+        range.firstIndex = static_cast<GLuint>(indices.size());
+        range.baseVertex = static_cast<GLint>(positions.size());
+
+        glm::vec3 boxMin = mesh->vertices[0].Position;
+        glm::vec3 boxMax = boxMin;
+        for (const Vertex &vertex : mesh->vertices)
+        {
+            positions.push_back(vertex.Position);
+            boxMin = glm::min(boxMin, vertex.Position);
+            boxMax = glm::max(boxMax, vertex.Position);
+        }
+
+        // Non-indexed meshes get a trivial index list so everything is one draw type
+        if (mesh->indices.empty())
+        {
+            for (size_t i = 0; i < mesh->vertices.size(); i++)
+                indices.push_back(static_cast<GLuint>(i));
+            range.indexCount = static_cast<GLsizei>(mesh->vertices.size());
+        }
+        else
+        {
+            indices.insert(indices.end(), mesh->indices.begin(), mesh->indices.end());
+            range.indexCount = static_cast<GLsizei>(mesh->indices.size());
+        }
+
+        range.center = (boxMin + boxMax) * 0.5f;
+        range.radius = glm::length(boxMax - boxMin) * 0.5f;
+        found = ranges.emplace(mesh, range).first;
+    }
+
+    const Range &range = found->second;
+    float scale = std::max(glm::length(glm::vec3(model[0])),
+                           std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+
+    Caster caster;
+    caster.range = range;
+    caster.model = model;
+    caster.center = glm::vec3(model * glm::vec4(range.center, 1.0f));
+    caster.radius = range.radius * scale;
+    casters.push_back(caster);
+}
+
+void ShadowCasters::upload()
+{
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec3), positions.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+
+    // Position only (location = 0), tightly packed
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void *)0);
+    glBindVertexArray(0);
+
+    std::cout << "Shadow casters: " << casters.size() << " draws, " << ranges.size() << " meshes, "
+              << positions.size() * sizeof(glm::vec3) / 1024 << " KB of positions" << std::endl;
+
+    ranges.clear();
+    std::vector<glm::vec3>().swap(positions);
+    std::vector<GLuint>().swap(indices);
+}
+
+int ShadowCasters::draw(Shader &shader, const Frustum &frustum) const
+{
+    int drawn = 0;
+    glBindVertexArray(VAO);
+
+    for (const Caster &caster : casters)
+    {
+        if (!frustum.containsSphere(caster.center, caster.radius))
+            continue;
+
+        shader.setMat4("model", caster.model);
+        glDrawElementsBaseVertex(GL_TRIANGLES, caster.range.indexCount, GL_UNSIGNED_INT,
+                                 (void *)(caster.range.firstIndex * sizeof(GLuint)), caster.range.baseVertex);
+        drawn++;
+    }
+
+    glBindVertexArray(0);
+    return drawn;
+}
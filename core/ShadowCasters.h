@@ -0,0 +1,67 @@
+#ifndef SHADOWCASTERS_H
+#define SHADOWCASTERS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <unordered_map>
+#include <vector>
+
+class Frustum;
+class Mesh;
+class Shader;
+
+/**
+ * Static shadow casters in one position-only vertex stream
+ * Built once after the scene is created: add() copies the positions (12
+ * bytes per vertex instead of the full 32-byte Vertex) and indices of every
+ * distinct mesh into shared arrays and records each caster's model matrix
+ * and world bounding sphere. upload() moves them into a single VAO, so the
+ * shadow pass binds one VAO and only sets the model matrix between draws -
+ * no textures, no material uniforms.
+ */
+class ShadowCasters
+{
+public:
+    ShadowCasters();
+    ~ShadowCasters();
+
+    // Building: meshes with castsShadow == false are skipped. A mesh must
+    // stay alive until upload(), since it is recognised by its address
+    void add(const Mesh *mesh, const glm::mat4 &model);
+
+    // Rendering (requires a current GL context); frees the CPU copies
+    void upload();
+
+    // Draw every caster whose bounds touch the frustum; returns the draw count
+    int draw(Shader &shader, const Frustum &frustum) const;
+
+    size_t size() const { return casters.size(); }
+
+private:
+    // Where one mesh lives in the shared buffers, plus its local bounds
+    struct Range
+    {
+        GLsizei indexCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        glm::vec3 center;
+        float radius;
+    };
+
+    struct Caster
+    {
+        Range range;
+        glm::mat4 model;
+        glm::vec3 center; // World bounding sphere
+        float radius;
+    };
+
+    std::unordered_map<const Mesh *, Range> ranges; // Build time only
+    std::vector<glm::vec3> positions;
+    std::vector<GLuint> indices;
+    std::vector<Caster> casters;
+
+    GLuint VAO, VBO, EBO;
+};
+
+#endif
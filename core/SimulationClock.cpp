@@ -0,0 +1,32 @@
+#include "SimulationClock.h"
+
+SimulationClock::SimulationClock(float step, int maxSteps)
+    : stepSeconds(step), maxStepsPerFrame(maxSteps), accumulator(0.0), time(0.0)
+{
+}
+
+void SimulationClock::advance(float frameSeconds)
+{
+    accumulator += frameSeconds;
+
+    // After a long hitch, slow the simulation down rather than jump ahead
+    const double maxBacklog = static_cast<double>(stepSeconds) * maxStepsPerFrame;
+    if (accumulator > maxBacklog)
+        accumulator = maxBacklog;
+}
+
+bool SimulationClock::step()
+{
+    if (accumulator < stepSeconds)
+        return false;
+
+    accumulator -= stepSeconds;
+    time += stepSeconds;
+    return true;
+}
+
+float SimulationClock::getInterpolatedTime() const
+{
+    // Rendering blends from the previous state (time - step) to the latest one
+    return static_cast<float>(time - stepSeconds * (1.0 - getAlpha()));
+}
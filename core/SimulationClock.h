@@ -0,0 +1,34 @@
+#ifndef SIMULATIONCLOCK_H
+#define SIMULATIONCLOCK_H
+
+/**
+ * Fixed-timestep simulation clock (accumulator)
+ * Frame times are accumulated and consumed in whole steps, so the simulation
+ * always advances by the same dt. getAlpha() is the fraction of a step left
+ * over, used to interpolate between the last two simulated states.
+ */
+class SimulationClock
+{
+public:
+    /**
+     * @param stepSeconds Simulation step (default 60 Hz)
+     * @param maxStepsPerFrame Longer hitches are dropped instead of replayed
+     */
+    SimulationClock(float stepSeconds = 1.0f / 60.0f, int maxStepsPerFrame = 5);
+
+    void advance(float frameSeconds);
+    bool step(); // Consumes one step if available
+
+    float getStep() const { return stepSeconds; }
+    float getAlpha() const { return static_cast<float>(accumulator / stepSeconds); }
+    double getTime() const { return time; }        // Time of the latest simulated state
+    float getInterpolatedTime() const;             // Time of the rendered (blended) state
+
+private:
+    float stepSeconds;
+    int maxStepsPerFrame;
+    double accumulator;
+    double time;
+};
+
+#endif
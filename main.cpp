@@ -10,20 +10,48 @@
 #include "Shader.h"
 #include "Mesh.h"
 #include "Texture.h"
+#include "TextureArray.h"
 #include "Primitives.h"
 #include "objects/Lang.h"
 #include "objects/CotCo.h"
 #include "objects/StreetLight.h"
 #include "TimeOfDay.h"
-#include "objects/Cloud.h"
-#include "objects/Bird.h"
+#include "AnimationSystem.h"
+#include "Flock.h"
+#include "JobSystem.h"
+#include "RenderQueue.h"
+#include "FrameSnapshot.h"
+#include "SimulationClock.h"
+#include "LightClusters.h"
+#include "ShadowCascades.h"
+#include "ShadowCasters.h"
+#include "CloudImpostors.h"
+#include "OcclusionQueries.h"
+#include "Noise.h"
+#include "FrameLimiter.h"
+#include "rendering/ShaderVariants.h"
+#include "rendering/DeferredRenderer.h"
+#include "rendering/RenderBenchmark.h"
+#include "rendering/OverdrawCounter.h"
+#include "rendering/VolumetricClouds.h"
+#include "rendering/DynamicResolution.h"
+#include "rendering/TextureStreamer.h"
+#include "rendering/ProceduralTexture.h"
+#include "rendering/FramePacer.h"
 #include "objects/Tree.h"
 #include "objects/Fence.h"
-#include "objects/Guard.h"
 
 #include <iostream>
 #include <vector>
 #include <ctime>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <thread>
 
 // Function prototypes
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
@@ -31,10 +59,16 @@ void mouse_callback(GLFWwindow *window, double xposIn, double yposIn);
 void scroll_callback(GLFWwindow *window, double xoffset, double yoffset);
 void processInput(GLFWwindow *window);
 
-// Settings
+// Settings (initial window size)
 const unsigned int SCR_WIDTH = 1600;
 const unsigned int SCR_HEIGHT = 1000;
 
+// Window framebuffer size, written by framebuffer_size_callback on the main
+// thread; the simulation takes the aspect ratio and the render thread the
+// output size from it
+std::atomic<int> framebufferWidth(SCR_WIDTH);
+std::atomic<int> framebufferHeight(SCR_HEIGHT);
+
 // Camera
 Camera camera(glm::vec3(0.0f, 30.0f, 70.0f)); // Centered in yard, elevated for better view
 float lastX = SCR_WIDTH / 2.0f;
@@ -49,12 +83,18 @@ float lastFrame = 0.0f;
 float lastTKeyPress = 0.0f;
 float lastUKeyPress = 0.0f;
 float lastLKeyPress = 0.0f;
+float lastPKeyPress = 0.0f;
+float lastOKeyPress = 0.0f;
+float lastCKeyPress = 0.0f;
 
 // Scene Objects (Global for RenderScene access)
 Mesh *pavement = nullptr;
 Mesh *sharedGrassPatch = nullptr;
 std::vector<glm::mat4> grassTransforms;
 Mesh *pathway = nullptr;
+Mesh *carpet = nullptr;         // Runner on each stair
+Mesh *walkway = nullptr;        // Horizontal concrete walkway
+Mesh *grandstandTier = nullptr; // One tier of a grandstand
 // grassGridLines removed
 LangBac *langBac = nullptr;
 Mesh *skyDome = nullptr;
@@ -62,14 +102,147 @@ Shader *skyShader = nullptr;
 Shader *cloudShader = nullptr;
 CotCo *cotCo = nullptr;
 std::vector<StreetLight *> lights;
-std::vector<Guard *> guards;
-std::vector<Cloud *> clouds;
-std::vector<Bird *> birds;
+AnimationSystem *animation = nullptr; // Guards and clouds (struct-of-arrays)
+Flock *pigeons = nullptr;             // Boids flock over the plaza (instanced)
+JobSystem *jobs = nullptr;            // Worker threads for updates, culling and queue building
+LightClusters *lightClusters = nullptr; // Street lights binned per view-space cluster
+ShadowCascades *shadowCascades = nullptr; // Sun shadow map layers fitted to the camera
+ShadowCasters *shadowCasters = nullptr;   // Static casters, position-only (built once)
+CloudImpostors *cloudImpostors = nullptr; // Sorted cloud sprites (transparent pass)
+OcclusionQueries *occlusionQueries = nullptr; // Skyline and back trees (--no-occlusion-culling)
+
+// Pigeon flock: count and the box it is steered to stay inside
+const int PIGEON_COUNT = 10000;
+const glm::vec3 PLAZA_MIN(-95.0f, 8.0f, -60.0f);
+const glm::vec3 PLAZA_MAX(95.0f, 35.0f, 95.0f);
+// Cascades pigeons cast into: the first two reach about 30 m from the camera
+// at 3-6 cm texels; further out a pigeon is a texel or two and not missed
+const int BIRD_SHADOW_CASCADES = 2;
 std::vector<Tree *> trees;
 std::vector<Mesh *> redFlags;
 std::vector<Fence *> fences;
 std::vector<Mesh *> backgroundBuildings;
 std::vector<glm::mat4> buildingTransforms;
+std::vector<glm::vec3> buildingHalfExtents; // For frustum culling
+std::vector<int> buildingOcclusionIds;      // OcclusionQueries ids, -1 = not tested
+std::vector<int> treeOcclusionIds;
+
+// Camera clip planes (projection and cluster depth reconstruction)
+const float CAMERA_NEAR = 0.1f;
+const float CAMERA_FAR = 2000.0f;
+
+// Texture units: 0 material, 1 shadow cascades, 2-4 light cluster buffers, 5-8 G-buffer,
+// 9-11 clouds (noise volume, depth, history / puff and impostor atlas), 12 upscale source,
+// 13 material layers
+const int SHADOW_TEXTURE_UNIT = 1;
+const int CLUSTER_TEXTURE_UNIT = 2;
+const int GBUFFER_TEXTURE_UNIT = 5;
+const int CLOUD_TEXTURE_UNIT = 9;
+const int UPSCALE_TEXTURE_UNIT = 12;
+const int MATERIAL_LAYERS_TEXTURE_UNIT = 13;
+
+// Dynamic resolution: the scene renders offscreen at a scale that holds the
+// GPU frame time at the budget (--frame-budget=<ms>, --fixed-resolution)
+DynamicResolution *dynamicResolution = nullptr;
+float frameBudgetMs = 16.6f;
+bool fixedResolution = false;
+
+// Render path (--renderer=forward|deferred); read by the render thread
+enum RendererPath
+{
+    RENDERER_FORWARD,
+    RENDERER_DEFERRED
+};
+RendererPath rendererPath = RENDERER_FORWARD;
+DeferredRenderer *deferredRenderer = nullptr; // Only created for the deferred path
+
+// Clouds (--clouds=volumetric|sprites): raymarched layer or sorted sprites
+enum CloudPath
+{
+    CLOUDS_VOLUMETRIC,
+    CLOUDS_SPRITES
+};
+CloudPath cloudPath = CLOUDS_VOLUMETRIC;
+VolumetricClouds *volumetricClouds = nullptr; // Only created for the volumetric path
+const float CLOUD_COVERAGE = 0.55f;           // Fraction of the sky band that is cloud
+
+// Sprite-path cloud puff, rendered by cloud_puff.fs (--cpu-cloud-texture:
+// GenerateCloudTexture). C regenerates it with the next seed: on the GPU
+// directly, on the CPU streamed in through the upload ring. On the GPU the
+// seed also drifts over the day, so the puff slowly changes shape. Every
+// new puff also rebakes the far-cloud impostor atlas through the ring
+const int CLOUD_TEXTURE_SIZE = 1024;
+const float CLOUD_SEED_STEP = 7.31f; // Noise-space offset between puffs
+const float CLOUD_DAY_DRIFT = 4.0f;  // Seed change over a full day
+const int CLOUD_DRIFT_STEPS = 96;    // Regenerations per day
+const int CLOUD_REBAKE_LEVEL = 2;    // GPU puff mip read back for rebakes (256x256)
+float cloudSeed = 0.0f;
+bool gpuCloudTexture = true;
+ProceduralTexture *proceduralTextures = nullptr;
+const int NOISE_TEXTURE_UNIT = 14;
+TextureStreamer *textureStreamer = nullptr;
+const size_t TEXTURE_STREAM_SLOT_BYTES = 4 * 1024 * 1024; // Fits a 1024x1024 RGBA image
+
+// Forward path: depth-only pre-pass before lighting (--depth-prepass, P key)
+// and the overdraw view (O key)
+bool depthPrepass = false;
+bool showOverdraw = false;
+const int OVERDRAW_REPORT_FRAMES = 60;
+
+// Occlusion culling: background buildings and trees from this row back are
+// tested against the mausoleum and grandstands
+bool occlusionCulling = true;
+const float OCCLUSION_BACK_ROW_Z = -35.0f;
+const int OCCLUSION_REPORT_FRAMES = 120;
+
+// Frame pacing: swap interval (--swap-interval=N, 0 = no vsync), frame rate
+// cap (--fps-limit=N) and frames the GPU may queue (--max-frames-in-flight=N).
+// --low-latency samples input only once the render thread is idle and keeps
+// one frame in flight
+int swapInterval = 1;
+float fpsLimit = 0.0f;
+int maxFramesInFlight = 0; // 0 = up to the driver
+bool lowLatency = false;
+const int FRAME_PACING_REPORT_FRAMES = 300;
+
+// --bench-renderer: hidden window, night scene, forward then deferred
+const int RENDER_BENCH_WARMUP_FRAMES = 60;
+const int RENDER_BENCH_FRAMES = 300;
+
+// lighting_v4.fs variants (bit i defines LIGHTING_FLAGS[i])
+enum LightingVariant
+{
+    NIGHT_LIGHTS = 1 << 0,     // Clustered street lights + flag spotlight
+    BUILDING_WINDOWS = 1 << 1, // Emissive windows
+    BULB_GLOW = 1 << 2,        // Emissive bulbs
+    LUMINANCE_ALPHA = 1 << 3,  // Alpha from brightness
+    SHADOW_TAPS_1 = 1 << 4,    // Shadow quality: one filtered tap (default is 4)
+    SHADOW_POISSON_16 = 1 << 5 // Shadow quality: 16 Poisson taps
+};
+const std::vector<std::string> LIGHTING_FLAGS = {"NIGHT_LIGHTS", "BUILDING_WINDOWS", "BULB_GLOW", "LUMINANCE_ALPHA",
+                                                 "SHADOW_TAPS_1", "SHADOW_POISSON_16"};
+
+// Shadow filter tier (--shadow-taps=1|4|16), added to every lighting variant
+unsigned int shadowQualityVariant = 0;
+
+// Programs RenderScene switches between
+struct ScenePrograms
+{
+    Shader *scene;
+    Shader *windows; // Background buildings
+    Shader *bulbs;   // Street light bulbs
+};
+
+// Programs for one pass over all opaque camera-visible geometry
+struct OpaquePrograms
+{
+    ScenePrograms scene;
+    Shader *flag;
+    Shader *birds;
+};
+
+// Trees further than this from the camera are drawn without branches
+const float TREE_LOD_DISTANCE = 80.0f;
 std::vector<Mesh *> textBanners;
 
 // Textures (Global)
@@ -78,538 +251,393 @@ Texture *stoneTexture = nullptr;
 Texture *concreteTexture = nullptr;
 Texture *flagTexture = nullptr;
 Texture *metalTexture = nullptr;
-Texture *yellowTexture = nullptr; // Inner walls
-Texture *textTexture = nullptr;   // Text on roof
-Texture *doorTexture = nullptr;   // Entrance door
 Texture *cloudTexture = nullptr;
 Texture *birdTexture = nullptr;
-Texture *guardUniformTexture = nullptr;
-Texture *guardHelmetTexture = nullptr;
-Texture *guardBootsTexture = nullptr;
-Texture *redCarpetTexture = nullptr; // Solid red texture for carpet
-// ===== PERLIN NOISE IMPLEMENTATION =====
-// Simple implementation for procedural cloud generation
-float fade(float t) { return t * t * t * (t * (t * 6 - 15) + 10); }
-float lerp(float t, float a, float b) { return a + t * (b - a); }
-float grad(int hash, float x, float y, float z)
-{
-    int h = hash & 15;
-    float u = h < 8 ? x : y;
-    float v = h < 4 ? y : h == 12 || h == 14 ? x
-                                             : z;
-    return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v);
-}
 
-// Permutation table
-int p[512];
-void initNoise()
+// One static placement, as drawn by RenderScene and cast into the shadow map
+struct ScenePart
 {
-    int permutation[] = {151, 160, 137, 91, 90, 15,
-                         131, 13, 201, 95, 96, 53, 194, 233, 7, 225, 140, 36, 103, 30, 69, 142, 8, 99, 37, 240, 21, 10, 23,
-                         190, 6, 148, 247, 120, 234, 75, 0, 26, 197, 62, 94, 252, 219, 203, 117, 35, 11, 32, 57, 177, 33,
-                         88, 237, 149, 56, 87, 174, 20, 125, 136, 171, 168, 68, 175, 74, 165, 71, 134, 139, 48, 27, 166,
-                         77, 146, 158, 231, 83, 111, 229, 122, 60, 211, 133, 230, 220, 105, 92, 41, 55, 46, 245, 40, 244,
-                         102, 143, 54, 65, 25, 63, 161, 1, 216, 80, 73, 209, 76, 132, 187, 208, 89, 18, 169, 200, 196,
-                         135, 130, 116, 188, 159, 86, 164, 100, 109, 198, 173, 186, 3, 64, 52, 217, 226, 250, 124, 123,
-                         5, 202, 38, 147, 118, 126, 255, 82, 85, 212, 207, 206, 59, 227, 47, 16, 58, 17, 182, 189, 28, 42,
-                         223, 183, 170, 213, 119, 248, 152, 2, 44, 154, 163, 70, 221, 153, 101, 155, 167, 43, 172, 9,
-                         129, 22, 39, 253, 19, 98, 108, 110, 79, 113, 224, 232, 178, 185, 112, 104, 218, 246, 97, 228,
-                         251, 34, 242, 193, 238, 210, 144, 12, 191, 179, 162, 241, 81, 51, 145, 235, 249, 14, 239, 107,
-                         49, 192, 214, 31, 181, 199, 106, 157, 184, 84, 204, 176, 115, 121, 50, 45, 127, 4, 150, 254,
-                         138, 236, 205, 93, 222, 114, 67, 29, 24, 72, 243, 141, 128, 195, 78, 66, 215, 61, 156, 180};
-    for (int i = 0; i < 256; i++)
-        p[256 + i] = p[i] = permutation[i];
-}
-
-float noise(float x, float y, float z)
+    Mesh *mesh;
+    glm::mat4 model;
+    Texture *texture;  // Unit 0; nullptr keeps whatever is bound
+    int materialLayer; // -1 = the 2D texture
+    glm::vec3 color;   // objectColor
+    bool bulb;         // Drawn with the bulb program
+};
+
+// Small and solid-colour materials: layers of one array texture, selected
+// per draw with the materialLayer uniform (-1 = the 2D texture on unit 0)
+const int MATERIAL_LAYER_SIZE = 256;
+TextureArray *materialLayers = nullptr;
+int redCarpetLayer = -1;
+int yellowLayer = -1; // Inner walls
+int guardUniformLayer = -1;
+int guardHelmetLayer = -1;
+int guardFaceLayer = -1;
+// Procedural noise: clouds here, the GPU generator copies its table
+PerlinNoise perlin;
+
+// Shape of the sprite-path cloud puff, shared by both generators
+struct CloudPuffParams
+{
+    float scale = 6.0f;                            // Noise cells across the texture
+    int octaves = 7;                               // 7 octaves for more detail
+    float seed = 0.0f;                             // Slice through the 3D noise
+    glm::vec2 mask = glm::vec2(0.3f, 0.95f);       // Radial fade, centre to edge
+    glm::vec2 threshold = glm::vec2(0.15f, 0.65f); // Smooth thresholding for softer clouds
+    float contrast = 1.1f;                         // Boost contrast slightly
+};
+
+void SetCloudPuffUniforms(Shader &shader, const CloudPuffParams &params)
 {
-    int X = (int)floor(x) & 255, Y = (int)floor(y) & 255, Z = (int)floor(z) & 255;
-    x -= floor(x);
-    y -= floor(y);
-    z -= floor(z);
-    float u = fade(x), v = fade(y), w = fade(z);
-    int A = p[X] + Y, AA = p[A] + Z, AB = p[A + 1] + Z, B = p[X + 1] + Y, BA = p[B] + Z, BB = p[B + 1] + Z;
-    return lerp(w, lerp(v, lerp(u, grad(p[AA], x, y, z), grad(p[BA], x - 1, y, z)), lerp(u, grad(p[AB], x, y - 1, z), grad(p[BB], x - 1, y - 1, z))),
-                lerp(v, lerp(u, grad(p[AA + 1], x, y, z - 1), grad(p[BA + 1], x - 1, y, z - 1)),
-                     lerp(u, grad(p[AB + 1], x, y - 1, z - 1), grad(p[BB + 1], x - 1, y - 1, z - 1))));
+    shader.use();
+    shader.setFloat("scale", params.scale);
+    shader.setInt("octaves", params.octaves);
+    shader.setFloat("seed", params.seed);
+    shader.setVec2("mask", params.mask);
+    shader.setVec2("threshold", params.threshold);
+    shader.setFloat("contrast", params.contrast);
 }
 
-// Fractal Brownian Motion
-float fbm(float x, float y, float z, int octaves)
+// Cloud puff for the sprite path on the CPU (size x size RGB, grey); the
+// noise rows are spread over workers when given a job system
+void GenerateCloudTexture(unsigned char *rgb, int size, const CloudPuffParams &params, JobSystem *workers)
 {
-    float total = 0.0f;
-    float frequency = 1.0f;
-    float amplitude = 1.0f;
-    float maxValue = 0.0f;
-    for (int i = 0; i < octaves; i++)
+    // FBM Noise with more octaves for detail, the whole image in one batch
+    std::vector<float> noise((size_t)size * size);
+    const float step = params.scale / size;
+    perlin.fbmBlock(noise.data(), size, size, 1, glm::vec3(0.0f, 0.0f, params.seed), glm::vec3(step, step, 0.0f),
+                    params.octaves, workers);
+
+    for (int y = 0; y < size; y++)
     {
-        total += noise(x * frequency, y * frequency, z * frequency) * amplitude;
-        maxValue += amplitude;
-        amplitude *= 0.5f;
-        frequency *= 2.0f;
-    }
-    return total / maxValue;
-}
+        for (int x = 0; x < size; x++)
+        {
+            // Normalized coordinates
+            float u = (float)x / size;
+            float v = (float)y / size;
 
-Texture *treeBarkTexture = nullptr;
-Texture *treeLeavesTexture = nullptr;
+            // Distance from center for radial mask
+            float cx = u * 2.0f - 1.0f;
+            float cy = v * 2.0f - 1.0f;
+            float dist = sqrt(cx * cx + cy * cy);
 
-// Function to render the scene (used for both Shadow Pass and Lighting Pass)
-void RenderScene(Shader &shader, bool isNight = false)
-{
-    // ===== RENDER SKY DOME (Only in Lighting Pass, not Shadow Pass) =====
-    // We detect if it's lighting pass by checking if shader is NOT the depth shader
-    // But RenderScene takes generic shader.
-    // We should move Sky Dome rendering OUT of RenderScene or add a flag.
-    // For simplicity, we'll assume if the shader program ID matches the main shader, we draw sky.
-    // Actually, RenderScene is called with `shader` (main) and `depthShader`.
-    // We can just check a uniform or pass a bool.
-    // Or better: Render Sky Dome in the main loop BEFORE calling RenderScene.
-    // BUT RenderScene is convenient.
-    // Set default object color (white)
-    shader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
+            // Map noise from [-1, 1] to [0, 1]
+            float n = noise[y * size + x] * 0.5f + 0.5f;
 
-    // Let's render Sky Dome in main loop, NOT here.
+            float intensity = n;
 
-    // ===== RENDER GROUND & PAVEMENT =====
-    // 1. Pavement (Concrete texture) - Base layer
-    if (concreteTexture)
-        concreteTexture->bind(0);
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, glm::vec3(0.0f, -0.01f, 0.0f)); // Slightly below 0
-    shader.setMat4("model", model);
-    if (pavement)
-        pavement->draw();
+            // Apply radial mask to make edges soft and transparent
+            float mask = 1.0f - glm::smoothstep(params.mask.x, params.mask.y, dist);
+            intensity = n * mask;
 
-    // 2. Grass Patches (Grass texture)    // Grass patches rendering - DISABLED per user request
-    // 2. Grass Patches (Grass texture)
-    if (grassTexture)
-        grassTexture->bind(0);
-    shader.setMat4("model", glm::mat4(1.0f));
+            intensity = glm::smoothstep(params.threshold.x, params.threshold.y, intensity);
+            intensity = pow(intensity, params.contrast);
 
-    if (sharedGrassPatch)
-    {
-        for (const auto &transform : grassTransforms)
-        {
-            shader.setMat4("model", transform);
-            sharedGrassPatch->draw();
+            int idx = (y * size + x) * 3;
+            unsigned char val = (unsigned char)(glm::clamp(intensity, 0.0f, 1.0f) * 255);
+            rgb[idx] = val;     // R
+            rgb[idx + 1] = val; // G
+            rgb[idx + 2] = val; // B
         }
     }
+}
 
-    // 3. Central Pathway (Stone texture) - DISABLED to avoid overlap with horizontal walkway
-    /*
-    if (stoneTexture) stoneTexture->bind(0);
-    model = glm::mat4(1.0f);
-    model = glm::translate(model, glm::vec3(0.0f, 0.06f, 0.0f)); // Slightly above grass
-    shader.setMat4("model", model);
-    if (pathway) pathway->draw();
-    */
+// Rebake the impostor atlas from a new puff image (RGB, size x size). The
+// bake runs on the streamer's worker and the atlas is replaced when the
+// upload lands, a frame or two later. Any thread
+void RequestImpostorRebake(std::shared_ptr<const std::vector<unsigned char>> puff, int size)
+{
+    const int width = CloudImpostors::ATLAS_COLUMNS * CloudImpostors::TILE_SIZE;
+    const int height = CloudImpostors::atlasRows(animation->getCloudCount()) * CloudImpostors::TILE_SIZE;
+    textureStreamer->request(cloudImpostors->getAtlasTexture(), width, height, GL_RGB,
+                             [puff, size](unsigned char *pixels)
+                             { CloudImpostors::bakeAtlas(*animation, puff->data(), size, pixels); });
+}
 
-    // ===== RENDER LANG BAC (PHOTO-ACCURATE) =====
-    if (stoneTexture)
-        stoneTexture->bind(0);
+// Tiling 3D FBM for the volumetric clouds (size^3 bytes, x fastest). Each
+// sample blends the 8 copies of the field shifted by one period, so the
+// volume wraps seamlessly; each copy is a batched row of noise, and slices
+// are spread over the job threads
+unsigned char *BuildCloudNoiseVolume(int size)
+{
+    const float period = 4.0f; // Noise lattice cells per tile
+    const float step = period / size;
+    unsigned char *voxels = new unsigned char[size * size * size];
+
+    jobs->parallel_for(size, 1, [&](size_t begin, size_t end)
+                       {
+                           std::vector<float> row(size), sum(size);
+                           for (size_t z = begin; z < end; z++)
+                           {
+                               for (int y = 0; y < size; y++)
+                               {
+                                   glm::vec3 p(0.0f, (float)y * step, (float)z * step);
+                                   std::fill(sum.begin(), sum.end(), 0.0f);
+                                   for (int corner = 0; corner < 8; corner++)
+                                   {
+                                       glm::vec3 shift((corner & 1) ? period : 0.0f, (corner & 2) ? period : 0.0f, (corner & 4) ? period : 0.0f);
+                                       // Weight of the shifted copy along y and z; x varies along the row
+                                       float weightYZ = ((corner & 2) ? p.y / period : 1.0f - p.y / period) *
+                                                        ((corner & 4) ? p.z / period : 1.0f - p.z / period);
+                                       perlin.fbmRow(row.data(), size, -shift.x, step, p.y - shift.y, p.z - shift.z, 4);
+                                       for (int x = 0; x < size; x++)
+                                       {
+                                           float wx = (float)x * step / period;
+                                           sum[x] += ((corner & 1) ? wx : 1.0f - wx) * weightYZ * row[x];
+                                       }
+                                   }
+                                   for (int x = 0; x < size; x++)
+                                   {
+                                       // Blending lowers the contrast; stretch it back
+                                       float value = glm::clamp(sum[x] * 0.8f + 0.5f, 0.0f, 1.0f);
+                                       voxels[(z * size + y) * size + x] = (unsigned char)(value * 255);
+                                   }
+                               }
+                           }
+                       });
+
+    return voxels;
+}
 
-    // Ground platform - mesh 0
-    glm::mat4 modelPlatform = glm::mat4(1.0f);
-    modelPlatform = glm::translate(modelPlatform, glm::vec3(0.0f, 0.25f, -10.0f));
-    shader.setMat4("model", modelPlatform);
-    if (langBac)
-        langBac->meshes[0]->draw();
+Texture *treeBarkTexture = nullptr;
+Texture *treeLeavesTexture = nullptr;
 
-    // Stairs (5 steps) - meshes 1-5
-    // Use stone texture for stairs
-    if (stoneTexture)
-        stoneTexture->bind(0);
+// Frustum culling + LOD for trees and background buildings, run as jobs;
+// the resulting queue is only submitted by the GL thread
+void BuildSceneQueue(RenderQueue &queue, const Frustum &frustum, glm::vec3 viewPos)
+{
+    queue.clear();
+
+    jobs->parallel_for(trees.size(), 8, [&](size_t begin, size_t end)
+                       {
+                           for (size_t i = begin; i < end; i++)
+                           {
+                               const Tree *tree = trees[i];
+                               if (!frustum.containsSphere(tree->getBoundsCenter(), tree->getBoundsRadius()))
+                                   continue;
+                               glm::vec3 toTree = tree->position - viewPos;
+                               bool detailed = glm::dot(toTree, toTree) < TREE_LOD_DISTANCE * TREE_LOD_DISTANCE;
+                               tree->appendDrawItems(queue, treeBarkTexture, treeLeavesTexture, detailed, treeOcclusionIds[i]);
+                           }
+                       });
+
+    jobs->parallel_for(backgroundBuildings.size(), 8, [&](size_t begin, size_t end)
+                       {
+                           for (size_t i = begin; i < end; i++)
+                           {
+                               glm::vec3 center = glm::vec3(buildingTransforms[i][3]);
+                               if (!frustum.containsBox(center - buildingHalfExtents[i], center + buildingHalfExtents[i]))
+                                   continue;
+                               queue.push({backgroundBuildings[i], metalTexture, buildingTransforms[i], true, buildingOcclusionIds[i]});
+                           }
+                       });
+
+    queue.finish();
+}
 
-    int numSteps = 5;
-    for (int i = 0; i < numSteps; i++)
+// Every static placement of the scene in draw order, bulbs last. RenderScene
+// draws these and BuildShadowCasters collects them, so each transform is
+// written once. Like the draw code, a part keeps the material of the one
+// before it unless it sets its own
+void ForEachScenePart(const std::function<void(const ScenePart &)> &visit)
+{
+    const glm::vec3 white(1.0f, 1.0f, 1.0f);
+    ScenePart part = {nullptr, glm::mat4(1.0f), nullptr, -1, white, false};
+    auto place = [&](Mesh *mesh, const glm::mat4 &model)
     {
-        glm::mat4 modelStep = glm::mat4(1.0f);
-        float yPos = 0.65f + i * 0.3f; // Comfortable rise (0.65, 0.95, 1.25, 1.55, 1.85)
-        // Fix Z-order: Steps should go UP towards the mausoleum (Z=-10)
-        // Lowest step (i=0) should be far (Z=13), Highest step (i=4) should be close (Z=1)
-        float zPos = 13.0f - i * 3.0f;
-        modelStep = glm::translate(modelStep, glm::vec3(0.0f, yPos, zPos));
-        shader.setMat4("model", modelStep);
-        if (langBac)
-            langBac->meshes[1 + i]->draw();
-    }
-
-    // Red carpet runner on stairs
-    if (redCarpetTexture)
-        redCarpetTexture->bind(0);
-    for (int i = 0; i < numSteps; i++)
+        if (!mesh)
+            return;
+        part.mesh = mesh;
+        part.model = model;
+        visit(part);
+    };
+    auto at = [](const glm::vec3 &position)
     {
-        glm::mat4 modelCarpet = glm::mat4(1.0f);
-        float yPos = 0.65f + i * 0.3f + 0.16f; // Slightly above step
-        float zPos = 13.0f - i * 3.0f;         // Match steps
-        modelCarpet = glm::translate(modelCarpet, glm::vec3(0.0f, yPos, zPos));
-        shader.setMat4("model", modelCarpet);
-
-        // Draw thin red carpet (8 units wide, 0.05 tall, 3.0 deep)
-        Mesh *carpet = Primitives::createBox(8.0f, 0.05f, 3.0f);
-        carpet->draw();
-        delete carpet;
-    }
-
-    // Lower Tier (base with entrance) - mesh 6
-    // Use STONE texture for gray granite appearance
-    if (stoneTexture)
-        stoneTexture->bind(0);
-    glm::mat4 modelLowerTier = glm::mat4(1.0f);
-    modelLowerTier = glm::translate(modelLowerTier, glm::vec3(0.0f, 3.5f, -10.0f));
-    shader.setMat4("model", modelLowerTier);
-    if (langBac)
-        langBac->meshes[6]->draw();
-
-    // ===== RENDER CONCRETE WALKWAY =====
-    // ===== RENDER CONCRETE WALKWAY =====
-    // Horizontal concrete walkway in front of mausoleum
-    if (concreteTexture)
-        concreteTexture->bind(0);
-
-    // Darker concrete for walkway (distinguish from ground)
-    shader.setVec3("objectColor", glm::vec3(0.6f, 0.6f, 0.6f));
-
-    glm::mat4 modelWalkway = glm::mat4(1.0f);
-    // Position: Horizontal across front (X=-100 to X=100), at Z=25
-    // Center at X=0, Z=25, Width 200 units (along X), Depth 20 units (along Z)
-    // Reduced width from 300 to 200 to match ground width
-    modelWalkway = glm::translate(modelWalkway, glm::vec3(0.0f, 0.02f, 25.0f));
-    shader.setMat4("model", modelWalkway);
-    // Use separate tiling for X and Z to keep texture square and smooth
-    // Width 200 -> Tiling 20 (10 units/repeat)
-    // Depth 20 -> Tiling 2 (10 units/repeat)
-    Mesh *concreteWalkway = Primitives::createPlane(200.0f, 20.0f, 20.0f, 2.0f);
-    concreteWalkway->draw();
-    delete concreteWalkway;
-
-    // Reset object color to white
-    shader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
+        return glm::translate(glm::mat4(1.0f), position);
+    };
 
-    // ===== RENDER GRASS =====
-    // Grass rendering disabled per user request
-    /*
-    if (grassTexture) grassTexture->bind(0);
-    glm::mat4 modelGrass = glm::mat4(1.0f);
-    modelGrass = glm::translate(modelGrass, glm::vec3(0.0f, 0.0f, 5.0f));
-    shader.setMat4("model", modelGrass);
-    Mesh* grassPlane = Primitives::createPlane(200.0f, 20.0f, 10.0f);
-    grassPlane->draw();
-    delete grassPlane;
-    */
+    // ===== GROUND & PAVEMENT =====
+    // 1. Pavement (Concrete texture) - Base layer, slightly below 0
+    part.texture = concreteTexture;
+    place(pavement, at(glm::vec3(0.0f, -0.01f, 0.0f)));
 
-    // ===== RENDER RESIDENTIAL HOUSES =====
-    // Houses removed per user request
-    /*
-    // Left end houses (X < -100)
-    for (int i = 0; i < 8; i++) {
-        float x = -110.0f - i * 15.0f; // X positions: -110, -125, -140, ...
-        float z = 25.0f; // Along walkway
-
-        // House base (walls)
-        if (stoneTexture) stoneTexture->bind(0);
-        glm::mat4 modelHouse = glm::mat4(1.0f);
-        modelHouse = glm::translate(modelHouse, glm::vec3(x, 3.0f, z));
-        shader.setMat4("model", modelHouse);
-        Mesh* houseBase = Primitives::createBox(8.0f, 6.0f, 10.0f);
-        houseBase->draw();
-        delete houseBase;
-
-        // Roof
-        if (metalTexture) metalTexture->bind(0);
-        glm::mat4 modelRoof = glm::mat4(1.0f);
-        modelRoof = glm::translate(modelRoof, glm::vec3(x, 7.0f, z));
-        shader.setMat4("model", modelRoof);
-        Mesh* roof = Primitives::createBox(9.0f, 2.0f, 11.0f);
-        roof->draw();
-        delete roof;
-    }
+    // 2. Grass Patches (Grass texture)
+    part.texture = grassTexture;
+    for (const auto &transform : grassTransforms)
+        place(sharedGrassPatch, transform);
 
-    // Right end houses (X > 100)
-    for (int i = 0; i < 8; i++) {
-        float x = 110.0f + i * 15.0f; // X positions: 110, 125, 140, ...
-        float z = 25.0f;
-
-        // House base
-        if (stoneTexture) stoneTexture->bind(0);
-        glm::mat4 modelHouse = glm::mat4(1.0f);
-        modelHouse = glm::translate(modelHouse, glm::vec3(x, 3.0f, z));
-        shader.setMat4("model", modelHouse);
-        Mesh* houseBase = Primitives::createBox(8.0f, 6.0f, 10.0f);
-        houseBase->draw();
-        delete houseBase;
-
-        // Roof
-        if (metalTexture) metalTexture->bind(0);
-        glm::mat4 modelRoof = glm::mat4(1.0f);
-        modelRoof = glm::translate(modelRoof, glm::vec3(x, 7.0f, z));
-        shader.setMat4("model", modelRoof);
-        Mesh* roof = Primitives::createBox(9.0f, 2.0f, 11.0f);
-        roof->draw();
-        delete roof;
-    }
-    */
+    // 3. Central Pathway - disabled to avoid overlap with horizontal walkway
 
-    // ===== RENDER GRANDSTANDS (Khán đài) =====
-    // Grandstands on left and right sides, aligned with mausoleum
-    // Use concrete texture for grandstands
-    if (concreteTexture)
-        concreteTexture->bind(0);
+    // ===== LANG BAC (PHOTO-ACCURATE) =====
+    if (langBac)
+    {
+        // Ground platform - mesh 0
+        part.texture = stoneTexture;
+        place(langBac->meshes[0], at(glm::vec3(0.0f, 0.25f, -10.0f)));
 
-    // Left Grandstand (left side of mausoleum)
-    // Aligned with mausoleum, not overlapping walkway
-    for (int i = 0; i < 5; i++)
-    { // 5 tiers (reduced from 7)
-        glm::mat4 modelStand = glm::mat4(1.0f);
-        // Position: Left of mausoleum
-        float yHeight = 2.0f + i * 1.5f; // Height increases (start at 2.0 instead of 0.5)
-        float xPos = -50.0f;             // Fixed X position (left side)
-        float zPos = 5.0f - i * 3.0f;    // Moved back (tier 0 at Z=5, tier 4 at Z=-7)
-        // Extended grandstand along X-axis
-        modelStand = glm::translate(modelStand, glm::vec3(xPos, yHeight, zPos));
-        shader.setMat4("model", modelStand);
-        Mesh *standTier = Primitives::createBox(60.0f, 2.0f, 10.0f); // Long along X (60 units), depth 10
-        standTier->draw();
-        delete standTier;
-    }
+        // Stairs (5 steps) - meshes 1-5, each with a red carpet runner on it
+        for (int i = 0; i < 5; i++)
+        {
+            float yPos = 0.65f + i * 0.3f; // Comfortable rise (0.65, 0.95, 1.25, 1.55, 1.85)
+            // Steps go UP towards the mausoleum (Z=-10): lowest (i=0) at Z=13, highest at Z=1
+            float zPos = 13.0f - i * 3.0f;
+            place(langBac->meshes[1 + i], at(glm::vec3(0.0f, yPos, zPos)));
+
+            // Array layer; stone stays bound for the tier
+            part.materialLayer = redCarpetLayer;
+            place(carpet, at(glm::vec3(0.0f, yPos + 0.16f, zPos))); // Slightly above step
+            part.materialLayer = -1;
+        }
 
-    // Right Grandstand (right side of mausoleum)
-    // Aligned with mausoleum, not overlapping walkway
-    for (int i = 0; i < 5; i++)
-    { // 5 tiers (reduced from 7)
-        glm::mat4 modelStand = glm::mat4(1.0f);
-        // Position: Right of mausoleum
-        float yHeight = 2.0f + i * 1.5f; // Height increases (start at 2.0 instead of 0.5)
-        float xPos = 50.0f;              // Fixed X position (right side)
-        float zPos = 5.0f - i * 3.0f;    // Moved back (tier 0 at Z=5, tier 4 at Z=-7)
-        // Extended grandstand along X-axis
-        modelStand = glm::translate(modelStand, glm::vec3(xPos, yHeight, zPos));
-        shader.setMat4("model", modelStand);
-        Mesh *standTier = Primitives::createBox(60.0f, 2.0f, 10.0f); // Long along X (60 units), depth 10
-        standTier->draw();
-        delete standTier;
+        // Lower Tier (base with entrance) - mesh 6, stone for gray granite
+        place(langBac->meshes[6], at(glm::vec3(0.0f, 3.5f, -10.0f)));
     }
 
-    // Entrance recess - mesh 7 (darker interior)
-    if (metalTexture)
-        metalTexture->bind(0);
-    glm::mat4 modelRecess = glm::mat4(1.0f);
-    modelRecess = glm::translate(modelRecess, glm::vec3(0.0f, 4.0f, -2.25f));
-    shader.setMat4("model", modelRecess);
-    if (langBac)
-        langBac->meshes[7]->draw();
+    // ===== CONCRETE WALKWAY =====
+    // Horizontal across the front at Z=25, darker to tell it from the ground
+    part.texture = concreteTexture;
+    part.color = glm::vec3(0.6f, 0.6f, 0.6f);
+    place(walkway, at(glm::vec3(0.0f, 0.02f, 25.0f)));
+    part.color = white;
 
-    // Door removed as requested
+    // Grass plane and residential houses removed per user request
 
-    // UPPER STAIRS (Tier 1 to Tier 2) - meshes 8-10
-    // Use stone texture
-    if (stoneTexture)
-        stoneTexture->bind(0);
-    for (int i = 0; i < 3; i++)
+    // ===== GRANDSTANDS (Khán đài) =====
+    // Left and right of the mausoleum, 5 tiers each, not overlapping the walkway
+    for (int i = 0; i < 5; i++)
     {
-        glm::mat4 modelUpStep = glm::mat4(1.0f);
-        // Position on top of lower tier (Y=6.0)
-        float yPos = 6.25f + i * 0.5f;
-        modelUpStep = glm::translate(modelUpStep, glm::vec3(0.0f, yPos, -10.0f));
-        shader.setMat4("model", modelUpStep);
-        if (langBac)
-            langBac->meshes[8 + i]->draw();
+        float yHeight = 2.0f + i * 1.5f; // Height increases
+        float zPos = 5.0f - i * 3.0f;    // Tier 0 at Z=5, tier 4 at Z=-7
+        place(grandstandTier, at(glm::vec3(-50.0f, yHeight, zPos)));
+        place(grandstandTier, at(glm::vec3(50.0f, yHeight, zPos)));
     }
 
-    // Upper Tier (Inner Yellow Walls) - mesh 11
-    // Use YELLOW texture
-    if (yellowTexture)
-        yellowTexture->bind(0);
-    glm::mat4 modelUpperTier = glm::mat4(1.0f);
-    // Centered inside columns (Z center approx -10.0)
-    modelUpperTier = glm::translate(modelUpperTier, glm::vec3(0.0f, 10.5f, -10.0f));
-    shader.setMat4("model", modelUpperTier);
     if (langBac)
-        langBac->meshes[11]->draw();
-
-    // 20 SQUARE COLUMNS - meshes 12-31
-    // Use metal texture for bronze/brown appearance
-    if (metalTexture)
-        metalTexture->bind(0);
-
-    int meshIndex = 12;
-
-    // 4 CORNER COLUMNS
-    float corners[4][2] = {
-        {-10.0f, -3.0f},  // Front-left
-        {10.0f, -3.0f},   // Front-right
-        {-10.0f, -17.0f}, // Back-left
-        {10.0f, -17.0f}   // Back-right
-    };
-
-    for (int i = 0; i < 4; i++)
     {
-        glm::mat4 modelCol = glm::mat4(1.0f);
-        modelCol = glm::translate(modelCol, glm::vec3(corners[i][0], 10.5f, corners[i][1]));
-        shader.setMat4("model", modelCol);
+        // Entrance recess - mesh 7 (darker interior)
+        part.texture = metalTexture;
+        place(langBac->meshes[7], at(glm::vec3(0.0f, 4.0f, -2.25f)));
+
+        // Door removed as requested
+
+        // UPPER STAIRS (Tier 1 to Tier 2) - meshes 8-10, on top of the lower tier
+        part.texture = stoneTexture;
+        for (int i = 0; i < 3; i++)
+            place(langBac->meshes[8 + i], at(glm::vec3(0.0f, 6.25f + i * 0.5f, -10.0f)));
+
+        // Upper Tier (Inner Yellow Walls) - mesh 11, centered inside the columns
+        part.materialLayer = yellowLayer;
+        place(langBac->meshes[11], at(glm::vec3(0.0f, 10.5f, -10.0f)));
+        part.materialLayer = -1;
+
+        // 20 SQUARE COLUMNS - meshes 12-31, metal for a bronze/brown look:
+        // 4 corners, then 4 each along the front, back, left and right
+        part.texture = metalTexture;
+        glm::vec2 columns[20] = {{-10.0f, -3.0f}, {10.0f, -3.0f}, {-10.0f, -17.0f}, {10.0f, -17.0f}};
+        for (int i = 0; i < 4; i++)
+        {
+            columns[4 + i] = glm::vec2(-6.0f + i * 4.0f, -3.0f);
+            columns[8 + i] = glm::vec2(-6.0f + i * 4.0f, -17.0f);
+            columns[12 + i] = glm::vec2(-10.0f, -6.0f - i * 3.5f);
+            columns[16 + i] = glm::vec2(10.0f, -6.0f - i * 3.5f);
+        }
+        for (int i = 0; i < 20; i++)
+            place(langBac->meshes[12 + i], at(glm::vec3(columns[i].x, 10.5f, columns[i].y)));
 
-        if (langBac)
-            langBac->meshes[meshIndex++]->draw();
-    }
+        // Roof - meshes 32-33: base, then the overhang sitting on the columns
+        part.texture = stoneTexture;
+        place(langBac->meshes[32], at(glm::vec3(0.0f, 15.0f, -10.0f)));
+        place(langBac->meshes[33], at(glm::vec3(0.0f, 15.75f, -10.0f)));
 
-    // FRONT SIDE - 4 columns (between corners)
-    for (int i = 0; i < 4; i++)
-    {
-        float x = -6.0f + i * 4.0f; // Evenly spaced
-        glm::mat4 modelCol = glm::mat4(1.0f);
-        modelCol = glm::translate(modelCol, glm::vec3(x, 10.5f, -3.0f));
-        shader.setMat4("model", modelCol);
-        if (langBac)
-            langBac->meshes[meshIndex++]->draw();
+        // Text rendering removed - clean roof facade as in reality
     }
 
-    // BACK SIDE - 4 columns
-    for (int i = 0; i < 4; i++)
+    // ===== COT CO =====
+    // Base and pole; the cloth is waved on the GPU and drawn separately (see RenderFlag)
+    if (cotCo)
     {
-        float x = -6.0f + i * 4.0f;
-        glm::mat4 modelCol = glm::mat4(1.0f);
-        modelCol = glm::translate(modelCol, glm::vec3(x, 10.5f, -17.0f));
-        shader.setMat4("model", modelCol);
-        if (langBac)
-            langBac->meshes[meshIndex++]->draw();
+        part.texture = stoneTexture;
+        place(cotCo->base, at(cotCo->position));
+        part.texture = metalTexture;
+        place(cotCo->pole, at(cotCo->position + glm::vec3(0.0f, 12.75f, 0.0f)));
     }
 
-    // LEFT SIDE - 4 columns
-    for (int i = 0; i < 4; i++)
-    {
-        float z = -6.0f - i * 3.5f; // Evenly spaced
-        glm::mat4 modelCol = glm::mat4(1.0f);
-        modelCol = glm::translate(modelCol, glm::vec3(-10.0f, 10.5f, z));
-        shader.setMat4("model", modelCol);
-        if (langBac)
-            langBac->meshes[meshIndex++]->draw();
-    }
+    // ===== STREET LIGHTS =====
+    // Poles, then every bulb (warm yellow, BULB_GLOW variant) so the
+    // renderer switches programs once
+    part.texture = metalTexture;
+    for (auto light : lights)
+        place(light->pole, at(light->position + glm::vec3(0.0f, 3.0f, 0.0f)));
 
-    // RIGHT SIDE - 4 columns
-    for (int i = 0; i < 4; i++)
+    part.color = glm::vec3(1.0f, 0.9f, 0.5f);
+    part.bulb = true;
+    for (auto light : lights)
     {
-        float z = -6.0f - i * 3.5f;
-        glm::mat4 modelCol = glm::mat4(1.0f);
-        modelCol = glm::translate(modelCol, glm::vec3(10.0f, 10.5f, z));
-        shader.setMat4("model", modelCol);
-        if (langBac)
-            langBac->meshes[meshIndex++]->draw();
+        place(light->bulb1, at(light->getLightPosition() + glm::vec3(-0.5f, 0.0f, 0.0f)));
+        place(light->bulb2, at(light->getLightPosition() + glm::vec3(0.5f, 0.0f, 0.0f)));
     }
+}
 
-    // Roof - meshes 32-33
-    if (stoneTexture)
-        stoneTexture->bind(0);
-    // Roof base
-    glm::mat4 modelRoofBase = glm::mat4(1.0f);
-    modelRoofBase = glm::translate(modelRoofBase, glm::vec3(0.0f, 15.0f, -10.0f));
-    shader.setMat4("model", modelRoofBase);
-    if (langBac)
-        langBac->meshes[32]->draw();
-
-    // Roof overhang (Facade)
-    glm::mat4 modelRoofOverhang = glm::mat4(1.0f);
-    // Center at 15.75 (Bottom 14.5, Top 17.0) - sits right on top of columns
-    modelRoofOverhang = glm::translate(modelRoofOverhang, glm::vec3(0.0f, 15.75f, -10.0f));
-    shader.setMat4("model", modelRoofOverhang);
-    if (langBac)
-        langBac->meshes[33]->draw();
-
-    // Text rendering removed - clean roof facade as in reality
-
-    // ===== RENDER COT CO =====
-    // Base
-    if (stoneTexture)
-        stoneTexture->bind(0);
-    glm::mat4 modelFlagBase = glm::mat4(1.0f);
-    modelFlagBase = glm::translate(modelFlagBase, cotCo->position);
-    shader.setMat4("model", modelFlagBase);
-    if (cotCo)
-        cotCo->base->draw();
-
-    // Pole
-    if (metalTexture)
-        metalTexture->bind(0);
-    glm::mat4 modelPole = glm::mat4(1.0f);
-    modelPole = glm::translate(modelPole, cotCo->position + glm::vec3(0.0f, 12.75f, 0.0f));
-    shader.setMat4("model", modelPole);
-    if (cotCo)
-        cotCo->pole->draw();
-
-    // Flag at top
-    if (flagTexture)
-        flagTexture->bind(0);
-    shader.setMat4("model", cotCo->getFlagTransform());
-    if (cotCo)
-        cotCo->flag->draw();
+void RenderScene(const ScenePrograms &programs, const RenderQueue &queue)
+{
+    Shader &shader = *programs.scene;
+
+    // Sky dome is rendered in the main loop, not here
+
+    // ===== RENDER STATIC SCENE =====
+    // Textures, layers and colours are only set when they change
+    const glm::vec3 white(1.0f, 1.0f, 1.0f);
+    Shader *current = &shader;
+    const Texture *boundTexture = nullptr;
+    int boundLayer = -1;
+    glm::vec3 boundColor = white;
+    shader.setVec3("objectColor", white);
+
+    ForEachScenePart([&](const ScenePart &part)
+                     {
+        if (part.bulb && current != programs.bulbs)
+        {
+            // Bulbs come last: one switch to the glow program for all of them
+            current = programs.bulbs;
+            current->use();
+            current->setVec3("objectColor", part.color);
+            boundColor = part.color;
+        }
+        if (part.texture && part.texture != boundTexture)
+        {
+            part.texture->bind(0);
+            boundTexture = part.texture;
+        }
+        if (part.materialLayer != boundLayer)
+        {
+            current->setInt("materialLayer", part.materialLayer);
+            boundLayer = part.materialLayer;
+        }
+        if (part.color != boundColor)
+        {
+            current->setVec3("objectColor", part.color);
+            boundColor = part.color;
+        }
+        current->setMat4("model", part.model);
+        part.mesh->draw(); });
 
-    // ===== RENDER STREET LIGHTS =====
-    // Street lights re-enabled
-    for (auto light : lights)
+    // Back to the scene program and reset color
+    if (current != &shader)
     {
-        // Pole
-        if (metalTexture)
-            metalTexture->bind(0);
-        glm::mat4 modelLightPole = glm::mat4(1.0f);
-        modelLightPole = glm::translate(modelLightPole, light->position + glm::vec3(0.0f, 3.0f, 0.0f));
-        shader.setMat4("model", modelLightPole);
-        light->pole->draw();
-
-        // Bulbs - Enable emissive glow at night
-        shader.setBool("enableBulbGlow", isNight);
-        shader.setVec3("objectColor", glm::vec3(1.0f, 0.9f, 0.5f)); // Warm yellow
-
-        glm::mat4 modelBulb1 = glm::mat4(1.0f);
-        modelBulb1 = glm::translate(modelBulb1, light->getLightPosition() + glm::vec3(-0.5f, 0.0f, 0.0f));
-        shader.setMat4("model", modelBulb1);
-        light->bulb1->draw();
-
-        glm::mat4 modelBulb2 = glm::mat4(1.0f);
-        modelBulb2 = glm::translate(modelBulb2, light->getLightPosition() + glm::vec3(0.5f, 0.0f, 0.0f));
-        shader.setMat4("model", modelBulb2);
-        light->bulb2->draw();
-
-        // Disable bulb glow and reset color
-        shader.setBool("enableBulbGlow", false);
-        shader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
+        current->setVec3("objectColor", white);
+        shader.use();
     }
+    shader.setVec3("objectColor", white);
+    shader.setInt("materialLayer", -1);
 
-    // ===== RENDER BIRDS =====
-    if (birdTexture)
-        birdTexture->bind(0);
-    for (auto bird : birds)
-    {
-        // Body
-        shader.setMat4("model", bird->getBodyTransform());
-        bird->body->draw();
-
-        // Head
-        shader.setMat4("model", bird->getHeadTransform());
-        bird->head->draw();
-
-        // Beak
-        shader.setMat4("model", bird->getBeakTransform());
-        bird->beak->draw();
-
-        // Tail
-        shader.setMat4("model", bird->getTailTransform());
-        bird->tail->draw();
+    // Pigeons are instanced and drawn separately (see RenderPigeons)
 
-        // Left Wing
-        shader.setMat4("model", bird->getLeftWingTransform());
-        bird->wingLeft->draw();
-
-        // Right Wing
-        shader.setMat4("model", bird->getRightWingTransform());
-        bird->wingRight->draw();
-    }
-
-    // ===== RENDER TREES =====
-    // Render ALL trees (removed limit)
-    for (auto tree : trees)
-    {
-        tree->draw(shader, treeBarkTexture, treeLeavesTexture);
-    }
+    // ===== RENDER TREES & BACKGROUND BUILDINGS =====
+    // Culled, LOD-selected and sorted by the frame jobs (see BuildSceneQueue);
+    // buildings use metal texture and the window variant. Occlusion-tested
+    // ones draw only if their box was visible last frame
+    queue.submit(shader, *programs.windows, occlusionQueries);
 
     // Small flags removed as requested for Scene Layout Redesign
 
@@ -629,26 +657,6 @@ void RenderScene(Shader &shader, bool isNight = false)
     // Reset object color to white
     shader.setVec3("objectColor", glm::vec3(1.0f, 1.0f, 1.0f));
 
-    // ===== RENDER BACKGROUND BUILDINGS =====
-    // Use metal texture for modern look (glass/steel)
-    if (metalTexture)
-        metalTexture->bind(0);
-
-    // Enable window lights ONLY for buildings
-    shader.setBool("enableWindowLights", true);
-
-    for (size_t i = 0; i < backgroundBuildings.size(); i++)
-    {
-        if (i < buildingTransforms.size())
-        {
-            shader.setMat4("model", buildingTransforms[i]);
-            backgroundBuildings[i]->draw();
-        }
-    }
-
-    // Disable window lights for other objects
-    shader.setBool("enableWindowLights", false);
-
     // ===== RENDER TEXT BANNERS =====
     // Text banners DISABLED per user request (flags at grandstands)
     /*
@@ -673,18 +681,306 @@ void RenderScene(Shader &shader, bool isNight = false)
     }
     */
 
-    // ===== RENDER GUARDS =====
-    for (auto guard : guards)
+    // Guards animate and are drawn separately (see RenderGuards)
+}
+
+// Static shadow casters: the RenderScene placement without materials, put
+// into one position-only stream
+void BuildShadowCasters()
+{
+    shadowCasters = new ShadowCasters();
+
+    ForEachScenePart([](const ScenePart &part)
+                     { shadowCasters->add(part.mesh, part.model); });
+
+    for (const Tree *tree : trees)
+        tree->appendShadowCasters(*shadowCasters);
+    for (size_t i = 0; i < backgroundBuildings.size(); i++)
+        shadowCasters->add(backgroundBuildings[i], buildingTransforms[i]);
+    for (const Fence *fence : fences)
+        fence->appendShadowCasters(*shadowCasters);
+
+    shadowCasters->upload();
+}
+
+// Occlusion-tested objects: every background building and the tree rows
+// behind the mausoleum, as world boxes. With --no-occlusion-culling all
+// ids stay -1 and the queue draws everything unconditionally
+void BuildOcclusionQueries()
+{
+    buildingOcclusionIds.assign(backgroundBuildings.size(), -1);
+    treeOcclusionIds.assign(trees.size(), -1);
+    if (!occlusionCulling)
+        return;
+
+    occlusionQueries = new OcclusionQueries();
+    for (size_t i = 0; i < backgroundBuildings.size(); i++)
+    {
+        glm::vec3 center = glm::vec3(buildingTransforms[i][3]);
+        buildingOcclusionIds[i] = occlusionQueries->add(center - buildingHalfExtents[i], center + buildingHalfExtents[i]);
+    }
+    for (size_t i = 0; i < trees.size(); i++)
     {
-        guard->draw(shader, guardUniformTexture, guardHelmetTexture, stoneTexture);
+        if (trees[i]->position.z > OCCLUSION_BACK_ROW_Z)
+            continue;
+        glm::vec3 center = trees[i]->getBoundsCenter();
+        glm::vec3 extent(trees[i]->getBoundsRadius());
+        treeOcclusionIds[i] = occlusionQueries->add(center - extent, center + extent);
     }
+    occlusionQueries->initRendering();
 }
 
-void key_callback(GLFWwindow *window, int key, int scancode, int action, int mods);
+// Guards: per-frame part matrices, so the shadow pass keeps them out of the static cache
+void RenderGuards(Shader &shader, const FrameSnapshot &frame)
+{
+    if (!animation)
+        return;
 
-int main()
+    for (size_t i = 0; i < frame.guardTransforms.size() / Guard::PART_COUNT; i++)
+    {
+        animation->guardModel->draw(shader, guardUniformLayer, guardHelmetLayer, guardFaceLayer,
+                                    &frame.guardTransforms[i * Guard::PART_COUNT]);
+    }
+}
 
+// Guard depth: no textures, parts without castsShadow (visors) left out
+void RenderGuardShadows(Shader &shader, const FrameSnapshot &frame)
 {
+    if (!animation)
+        return;
+
+    for (size_t i = 0; i < frame.guardTransforms.size() / Guard::PART_COUNT; i++)
+        animation->guardModel->drawShadowCasters(shader, &frame.guardTransforms[i * Guard::PART_COUNT]);
+}
+
+// Flag cloth: displaced in flag.vs (lighting) / flag_depth.vs (shadow), so it
+// needs its own program instead of the generic RenderScene shader
+void RenderFlag(Shader &shader, const FrameSnapshot &frame)
+{
+    if (!cotCo)
+        return;
+
+    shader.setMat4("model", cotCo->getFlagModel());
+    shader.setFloat("waveTime", frame.flagWaveTime);
+    shader.setFloat("flagRaise", frame.flagRaise);
+    shader.setFloat("flagWidth", CotCo::FLAG_WIDTH);
+    cotCo->flag->draw();
+}
+
+// Pigeons: one instanced draw per bird part (bird_instanced.vs / bird_instanced_depth.vs)
+void RenderPigeons(Shader &shader)
+{
+    if (!pigeons)
+        return;
+
+    if (birdTexture)
+        birdTexture->bind(0);
+    pigeons->draw(shader);
+}
+
+// Scene, flag and pigeons from the camera queue; applyUniforms runs once per program
+void RenderOpaque(const OpaquePrograms &programs, const FrameSnapshot &frame,
+                  void (*applyUniforms)(Shader &, const FrameLighting &))
+{
+    const ScenePrograms &scene = programs.scene;
+    if (scene.windows != scene.scene)
+        applyUniforms(*scene.windows, frame.lighting);
+    if (scene.bulbs != scene.scene && scene.bulbs != scene.windows)
+        applyUniforms(*scene.bulbs, frame.lighting);
+
+    applyUniforms(*scene.scene, frame.lighting);
+    RenderScene(scene, frame.cameraQueue);
+    RenderGuards(*scene.scene, frame);
+
+    applyUniforms(*programs.flag, frame.lighting);
+    if (flagTexture)
+        flagTexture->bind(0);
+    RenderFlag(*programs.flag, frame);
+
+    applyUniforms(*programs.birds, frame.lighting);
+    RenderPigeons(*programs.birds);
+}
+
+// Headless flock benchmark: birds vs. update time (run with --bench-flock)
+int RunFlockBenchmark()
+{
+    const int counts[] = {1000, 2500, 5000, 10000, 20000};
+    const int warmupSteps = 30;
+    const int measuredSteps = 200;
+    const float step = 1.0f / 60.0f;
+    JobSystem benchJobs;
+
+    std::cout << "Flock benchmark: " << benchJobs.getThreadCount() << " thread(s), " << measuredSteps << " steps at 60 Hz" << std::endl;
+    std::cout << "birds\tupdate ms" << std::endl;
+    for (int count : counts)
+    {
+        Flock flock(count, PLAZA_MIN, PLAZA_MAX);
+        for (int i = 0; i < warmupSteps; i++)
+            flock.update(step, &benchJobs);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < measuredSteps; i++)
+        {
+            flock.update(step, &benchJobs);
+            flock.writeInstances();
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << count << "\t" << elapsed.count() / measuredSteps << std::endl;
+    }
+    return 0;
+}
+
+// Headless noise benchmark: the sprite cloud puff's FBM (1024^2, 7 octaves)
+// per kernel, on one thread and over the job threads (run with --bench-noise)
+int RunNoiseBenchmark()
+{
+    const int size = CLOUD_TEXTURE_SIZE;
+    const int octaves = 7;
+    const int runs = 5;
+    JobSystem benchJobs;
+    PerlinNoise benchNoise;
+    std::vector<float> image((size_t)size * size);
+    const float step = 6.0f / size;
+
+    std::cout << "Noise benchmark: " << size << "x" << size << " FBM, " << octaves << " octaves, "
+              << benchJobs.getThreadCount() << " thread(s), best of " << runs << std::endl;
+    std::cout << "kernel	1 thread ms	jobs ms" << std::endl;
+    for (int k = PerlinNoise::KERNEL_SCALAR; k <= PerlinNoise::bestKernel(); k++)
+    {
+        benchNoise.setKernel(static_cast<PerlinNoise::Kernel>(k));
+        double best[2] = {1e9, 1e9};
+        for (int run = 0; run < runs; run++)
+        {
+            for (int threaded = 0; threaded < 2; threaded++)
+            {
+                auto start = std::chrono::steady_clock::now();
+                benchNoise.fbmBlock(image.data(), size, size, 1, glm::vec3(0.0f), glm::vec3(step, step, 0.0f), octaves,
+                                    threaded ? &benchJobs : nullptr);
+                std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+                best[threaded] = std::min(best[threaded], elapsed.count());
+            }
+        }
+        std::cout << PerlinNoise::kernelName(benchNoise.getKernel()) << "\t" << best[0] << "\t" << best[1] << std::endl;
+    }
+    return 0;
+}
+
+// Street lights as point lights (unlit by day, so the clusters stay empty)
+std::vector<LightClusters::PointLight> GatherPointLights(bool isNight)
+{
+    std::vector<LightClusters::PointLight> pointLights;
+    if (!isNight)
+        return pointLights;
+
+    glm::vec3 streetLightColor = glm::vec3(1.0f, 0.9f, 0.5f);
+    for (auto light : lights)
+    {
+        LightClusters::PointLight pointLight;
+        pointLight.position = light->getLightPosition() + glm::vec3(0, -0.5f, 0);
+        pointLight.ambient = streetLightColor * 0.1f;
+        pointLight.diffuse = streetLightColor * 1.5f;
+        pointLight.specular = streetLightColor * 1.0f;
+        pointLight.constant = 1.0f;
+        pointLight.linear = 0.09f;
+        pointLight.quadratic = 0.032f;
+        pointLights.push_back(pointLight);
+    }
+    return pointLights;
+}
+
+// Camera, material and time uniforms (all a G-buffer program needs)
+void ApplyCameraUniforms(Shader &shader, const FrameLighting &lighting)
+{
+    shader.use();
+    shader.setInt("material.diffuse", 0);
+    shader.setInt("materialLayers", MATERIAL_LAYERS_TEXTURE_UNIT);
+    shader.setFloat("material.shininess", 4.0f);
+
+    shader.setMat4("projection", lighting.projection);
+    shader.setMat4("view", lighting.view);
+    shader.setVec3("viewPos", lighting.viewPos);
+
+    // Window light flicker (BUILDING_WINDOWS variant)
+    shader.setFloat("time", lighting.time);
+}
+
+// Upload camera, sun, street light and spot light uniforms to a lighting program
+void ApplySceneLighting(Shader &shader, const FrameLighting &lighting)
+{
+    ApplyCameraUniforms(shader, lighting);
+    shadowCascades->applyUniforms(shader, SHADOW_TEXTURE_UNIT, lighting.shadows);
+
+    shader.setVec3("dirLight.direction", lighting.sunDir);
+    shader.setVec3("dirLight.ambient", lighting.sunColor * lighting.ambientStrength);
+    shader.setVec3("dirLight.diffuse", lighting.sunColor * 0.8f);
+    shader.setVec3("dirLight.specular", lighting.sunColor * 0.5f);
+
+    // Street lights come from the cluster buffers (see GatherPointLights)
+    glm::vec2 renderSize((float)dynamicResolution->getRenderWidth(), (float)dynamicResolution->getRenderHeight());
+    lightClusters->applyUniforms(shader, CLUSTER_TEXTURE_UNIT, renderSize,
+                                 CAMERA_NEAR, CAMERA_FAR);
+
+    shader.setVec3("spotLight.position", cotCo->position + glm::vec3(0.0f, 0.5f, 2.0f));
+    shader.setVec3("spotLight.direction", glm::vec3(0.0f, 1.0f, -0.2f));
+    shader.setFloat("spotLight.cutOff", glm::cos(glm::radians(12.5f)));
+    shader.setFloat("spotLight.outerCutOff", glm::cos(glm::radians(17.5f)));
+    shader.setFloat("spotLight.constant", 1.0f);
+    shader.setFloat("spotLight.linear", 0.09f);
+    shader.setFloat("spotLight.quadratic", 0.032f);
+
+    glm::vec3 spotColor = lighting.isNight ? glm::vec3(1.0f) : glm::vec3(0.0f);
+    shader.setVec3("spotLight.ambient", glm::vec3(0.0f));
+    shader.setVec3("spotLight.diffuse", spotColor);
+    shader.setVec3("spotLight.specular", spotColor);
+}
+
+void key_callback(GLFWwindow *window, int key, int scancode, int action, int mods);
+
+int main(int argc, char **argv)
+{
+    bool benchRenderer = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--bench-flock") == 0)
+            return RunFlockBenchmark();
+        else if (std::strcmp(argv[i], "--bench-noise") == 0)
+            return RunNoiseBenchmark();
+        if (std::strcmp(argv[i], "--renderer=deferred") == 0)
+            rendererPath = RENDERER_DEFERRED;
+        else if (std::strcmp(argv[i], "--renderer=forward") == 0)
+            rendererPath = RENDERER_FORWARD;
+        else if (std::strcmp(argv[i], "--bench-renderer") == 0)
+            benchRenderer = true;
+        else if (std::strcmp(argv[i], "--depth-prepass") == 0)
+            depthPrepass = true;
+        else if (std::strcmp(argv[i], "--shadow-taps=1") == 0)
+            shadowQualityVariant = SHADOW_TAPS_1;
+        else if (std::strcmp(argv[i], "--shadow-taps=4") == 0)
+            shadowQualityVariant = 0;
+        else if (std::strcmp(argv[i], "--shadow-taps=16") == 0)
+            shadowQualityVariant = SHADOW_POISSON_16;
+        else if (std::strcmp(argv[i], "--clouds=volumetric") == 0)
+            cloudPath = CLOUDS_VOLUMETRIC;
+        else if (std::strcmp(argv[i], "--clouds=sprites") == 0)
+            cloudPath = CLOUDS_SPRITES;
+        else if (std::strncmp(argv[i], "--frame-budget=", 15) == 0)
+            frameBudgetMs = std::max(1.0f, (float)std::atof(argv[i] + 15));
+        else if (std::strcmp(argv[i], "--fixed-resolution") == 0)
+            fixedResolution = true;
+        else if (std::strcmp(argv[i], "--no-occlusion-culling") == 0)
+            occlusionCulling = false;
+        else if (std::strcmp(argv[i], "--cpu-cloud-texture") == 0)
+            gpuCloudTexture = false;
+        else if (std::strncmp(argv[i], "--swap-interval=", 16) == 0)
+            swapInterval = std::max(0, std::atoi(argv[i] + 16));
+        else if (std::strncmp(argv[i], "--fps-limit=", 12) == 0)
+            fpsLimit = std::max(0.0f, (float)std::atof(argv[i] + 12));
+        else if (std::strncmp(argv[i], "--max-frames-in-flight=", 23) == 0)
+            maxFramesInFlight = std::max(0, std::atoi(argv[i] + 23));
+        else if (std::strcmp(argv[i], "--low-latency") == 0)
+            lowLatency = true;
+    }
+
     // =====GLFW Init=====
     srand(static_cast<unsigned int>(time(0))); // Seed random number generator
     // glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_X11); // Commented out for Docker compatibility
@@ -696,6 +992,8 @@ int main()
 #ifdef __APPLE__
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
+    if (benchRenderer)
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE); // Headless: nothing to look at
 
     // Open window
     GLFWwindow *window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Do An Do Hoa May Tinh - Lang Bac", NULL, NULL);
@@ -707,6 +1005,12 @@ int main()
     }
     glfwMakeContextCurrent(window);
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    {
+        // May differ from the window size on high-DPI displays
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        framebuffer_size_callback(window, width, height);
+    }
     glfwSetCursorPosCallback(window, mouse_callback);
     glfwSetScrollCallback(window, scroll_callback);
     glfwSetKeyCallback(window, key_callback);
@@ -730,9 +1034,58 @@ int main()
     {
 
         // Build and compile shaders
-        Shader lightingShader("../shaders/lighting_v4.vs", "../shaders/lighting_v4.fs"); // Use v4 lighting
+        // lighting_v4.fs permutations per vertex shader (see LightingVariant)
+        ShaderVariants lightingVariants("../shaders/lighting_v4.vs", "../shaders/lighting_v4.fs", LIGHTING_FLAGS);
+        ShaderVariants flagVariants("../shaders/flag.vs", "../shaders/lighting_v4.fs", LIGHTING_FLAGS);          // GPU-waved flag
+        ShaderVariants birdVariants("../shaders/bird_instanced.vs", "../shaders/lighting_v4.fs", LIGHTING_FLAGS); // Instanced pigeons
+
+        // Compile the day and night sets up front so dusk does not hitch
+        for (unsigned int base : {0u, (unsigned int)NIGHT_LIGHTS})
+        {
+            lightingVariants.get(base | shadowQualityVariant);
+            flagVariants.get(base | shadowQualityVariant);
+            birdVariants.get(base | shadowQualityVariant);
+        }
+        lightingVariants.get(NIGHT_LIGHTS | BUILDING_WINDOWS | shadowQualityVariant);
+        lightingVariants.get(NIGHT_LIGHTS | BULB_GLOW | shadowQualityVariant);
+
+        // Deferred path: G-buffer writers per vertex shader, then the light passes
+        ShaderVariants gbufferVariants("../shaders/lighting_v4.vs", "../shaders/gbuffer.fs", LIGHTING_FLAGS);
+        ShaderVariants gbufferFlagVariants("../shaders/flag.vs", "../shaders/gbuffer.fs", LIGHTING_FLAGS);
+        ShaderVariants gbufferBirdVariants("../shaders/bird_instanced.vs", "../shaders/gbuffer.fs", LIGHTING_FLAGS);
+        ShaderVariants deferredSunVariants("../shaders/deferred_light.vs", "../shaders/deferred_sun.fs", LIGHTING_FLAGS);
+        Shader pointLightShader("../shaders/deferred_point.vs", "../shaders/deferred_point.fs");
+
+        // Forward depth pre-pass and overdraw view, on the colour pass's vertex shaders
+        Shader prepassShader("../shaders/lighting_v4.vs", "../shaders/depth_prepass.fs");
+        Shader flagPrepassShader("../shaders/flag.vs", "../shaders/depth_prepass.fs");
+        Shader birdPrepassShader("../shaders/bird_instanced.vs", "../shaders/depth_prepass.fs");
+        Shader overdrawShader("../shaders/lighting_v4.vs", "../shaders/overdraw.fs");
+        Shader flagOverdrawShader("../shaders/flag.vs", "../shaders/overdraw.fs");
+        Shader birdOverdrawShader("../shaders/bird_instanced.vs", "../shaders/overdraw.fs");
+        if (rendererPath == RENDERER_DEFERRED || benchRenderer)
+        {
+            for (unsigned int flags : {0u, (unsigned int)BUILDING_WINDOWS, (unsigned int)BULB_GLOW})
+                gbufferVariants.get(flags);
+            gbufferFlagVariants.get(0);
+            gbufferBirdVariants.get(0);
+            deferredSunVariants.get(shadowQualityVariant);
+            deferredSunVariants.get(NIGHT_LIGHTS | shadowQualityVariant);
+            deferredRenderer = new DeferredRenderer(framebufferWidth, framebufferHeight);
+        }
+
+        // The benchmark times fixed work, and its timer query cannot nest with ours
+        dynamicResolution = new DynamicResolution(framebufferWidth, framebufferHeight, frameBudgetMs,
+                                                  !fixedResolution && !benchRenderer);
+        Shader upscaleShader("../shaders/deferred_light.vs", "../shaders/upscale.fs");
+
         Shader shadowShader("../shaders/shadow_mapping_depth.vs", "../shaders/shadow_mapping_depth.fs");
+        Shader flagDepthShader("../shaders/flag_depth.vs", "../shaders/shadow_mapping_depth.fs");
+        Shader birdDepthShader("../shaders/bird_instanced_depth.vs", "../shaders/shadow_mapping_depth.fs");
         Shader *cloudShader = new Shader("../shaders/cloud.vs", "../shaders/cloud.fs"); // New cloud shader
+        Shader cloudMarchShader("../shaders/deferred_light.vs", "../shaders/clouds_march.fs");
+        Shader cloudCompositeShader("../shaders/deferred_light.vs", "../shaders/clouds_composite.fs");
+        Shader cloudPuffShader("../shaders/deferred_light.vs", "../shaders/cloud_puff.fs");
         Shader *skyShader = new Shader("../shaders/sky.vs", "../shaders/sky.fs");       // Sky shader
 
         // Load textures
@@ -747,30 +1100,14 @@ int main()
         treeBarkTexture = new Texture("../assets/textures/tree_bark.png");
         treeLeavesTexture = new Texture("../assets/textures/tree_leaves.png");
 
-        // Guard textures
-        guardUniformTexture = new Texture("../assets/textures/guard_uniform.png");
-        guardHelmetTexture = new Texture("../assets/textures/guard_helmet.png");
-        // Reuse metal for boots/gun or load specific if needed (using metal for now as placeholder if not loaded)
-        // Actually we have guard_boots.png
-        Texture *guardBootsTexture = new Texture("../assets/textures/guard_boots.png");
-
-        // Additional textures
-        // Additional textures
-        unsigned char *redData = new unsigned char[3]{160, 0, 0};
-        redCarpetTexture = new Texture(1, 1, redData, GL_RGB);
-        delete[] redData;
-
-        unsigned char *yellowData = new unsigned char[3]{255, 200, 0};
-        yellowTexture = new Texture(1, 1, yellowData, GL_RGB);
-        delete[] yellowData;
-
-        unsigned char *whiteData = new unsigned char[3]{255, 255, 255};
-        textTexture = new Texture(1, 1, whiteData, GL_RGB);
-        delete[] whiteData;
-
-        unsigned char *doorData = new unsigned char[3]{40, 30, 20};
-        doorTexture = new Texture(1, 1, doorData, GL_RGB);
-        delete[] doorData;
+        // Solid colours and the guard parts share one array texture
+        materialLayers = new TextureArray(MATERIAL_LAYER_SIZE);
+        redCarpetLayer = materialLayers->addColor(160, 0, 0);
+        yellowLayer = materialLayers->addColor(255, 200, 0);
+        guardUniformLayer = materialLayers->addFile("../assets/textures/guard_uniform.png");
+        guardHelmetLayer = materialLayers->addFile("../assets/textures/guard_helmet.png");
+        guardFaceLayer = materialLayers->addFile("../assets/textures/stone.png");
+        materialLayers->upload();
 
         // Set texture filtering for pixel art style or sharp edges
         birdTexture->setFiltering(GL_NEAREST, GL_NEAREST);
@@ -807,11 +1144,16 @@ int main()
         // Create Street Lights - Legacy loop removed to prevent duplicates
         // Lights are now handled in the grass area section (around line 900)
 
-        // Create Birds
-        for (int i = 0; i < 15; i++)
-        {
-            birds.push_back(new Bird(glm::vec3(0.0f, 20.0f + (rand() % 10), -10.0f + (rand() % 20)), 30.0f + (rand() % 10), i * 0.5f));
-        }
+        // Animated objects share meshes and live in one struct-of-arrays system
+        animation = new AnimationSystem();
+
+        // Job system (one thread per core)
+        jobs = new JobSystem();
+        std::cout << "Job system: " << jobs->getThreadCount() << " thread(s)" << std::endl;
+
+        // Pigeon flock over the plaza (boids + landing state machine)
+        pigeons = new Flock(PIGEON_COUNT, PLAZA_MIN, PLAZA_MAX, static_cast<unsigned int>(rand()));
+        pigeons->initRendering();
 
         // Trees are now created later in the initialization (lines 881-904)
         // All trees positioned behind mausoleum and grandstands (Z < -15)
@@ -823,64 +1165,48 @@ int main()
         // ...
         */
 
-        // Initialize Noise
-        initNoise();
-
         // Generate Procedural Cloud Texture using FBM Noise
-        const int cloudTexSize = 1024;                                                 // Higher resolution for sharper details
-        unsigned char *cloudData = new unsigned char[cloudTexSize * cloudTexSize * 3]; // RGB
-
-        for (int y = 0; y < cloudTexSize; y++)
+        unsigned char *cloudData = new unsigned char[CLOUD_TEXTURE_SIZE * CLOUD_TEXTURE_SIZE * 3]; // RGB
+        CloudPuffParams cloudPuff;
+        cloudPuff.seed = cloudSeed;
+        if (gpuCloudTexture)
         {
-            for (int x = 0; x < cloudTexSize; x++)
+            // Rendered straight into the texture (RGBA: byte RGBA is always
+            // renderable, RGB need not be); the impostor bake (once the
+            // clouds exist) still wants the pixels, so read them back once
+            cloudTexture = new Texture(CLOUD_TEXTURE_SIZE, CLOUD_TEXTURE_SIZE, nullptr, GL_RGBA);
+            proceduralTextures = new ProceduralTexture(perlin.getPermutation(), NOISE_TEXTURE_UNIT);
+            SetCloudPuffUniforms(cloudPuffShader, cloudPuff);
+            if (proceduralTextures->generate(cloudPuffShader, *cloudTexture, CLOUD_TEXTURE_SIZE, CLOUD_TEXTURE_SIZE))
+                ProceduralTexture::readBack(*cloudTexture, GL_RGB, cloudData);
+            else
             {
-                // Normalized coordinates
-                float u = (float)x / cloudTexSize;
-                float v = (float)y / cloudTexSize;
-
-                // Distance from center for radial mask
-                float cx = u * 2.0f - 1.0f;
-                float cy = v * 2.0f - 1.0f;
-                float dist = sqrt(cx * cx + cy * cy);
-
-                // FBM Noise with more octaves for detail
-                float scale = 6.0f;
-                float n = fbm(u * scale, v * scale, 0.0f, 7); // 7 octaves for more detail
-
-                // Map noise from [-1, 1] to [0, 1]
-                n = n * 0.5f + 0.5f;
-
-                float intensity = n;
-
-                // Apply radial mask to make edges soft and transparent
-                float mask = 1.0f - glm::smoothstep(0.3f, 0.95f, dist);
-                intensity = n * mask;
-
-                // Smooth thresholding for softer clouds
-                intensity = glm::smoothstep(0.15f, 0.65f, intensity);
-
-                // Boost contrast slightly
-                intensity = pow(intensity, 1.1f);
-
-                int idx = (y * cloudTexSize + x) * 3;
-                unsigned char val = (unsigned char)(glm::clamp(intensity, 0.0f, 1.0f) * 255);
-                cloudData[idx] = val;     // R
-                cloudData[idx + 1] = val; // G
-                cloudData[idx + 2] = val; // B
+                std::cout << "GPU cloud texture unavailable, generating it on the CPU" << std::endl;
+                gpuCloudTexture = false;
+                delete proceduralTextures;
+                proceduralTextures = nullptr;
+                delete cloudTexture;
             }
         }
-        cloudTexture = new Texture(cloudTexSize, cloudTexSize, cloudData, GL_RGB);
-        delete[] cloudData;
+        if (!gpuCloudTexture)
+        {
+            GenerateCloudTexture(cloudData, CLOUD_TEXTURE_SIZE, cloudPuff, jobs);
+            cloudTexture = new Texture(CLOUD_TEXTURE_SIZE, CLOUD_TEXTURE_SIZE, cloudData, GL_RGB);
+        }
+        textureStreamer = new TextureStreamer(TEXTURE_STREAM_SLOT_BYTES);
+
+        if (cloudPath == CLOUDS_VOLUMETRIC)
+        {
+            unsigned char *cloudVolume = BuildCloudNoiseVolume(VolumetricClouds::NOISE_SIZE);
+            volumetricClouds = new VolumetricClouds(framebufferWidth, framebufferHeight);
+            volumetricClouds->setNoiseVolume(cloudVolume);
+            delete[] cloudVolume;
+        }
 
         // cloudTexture = new Texture("../assets/textures/cloud.png"); // Replaced with procedural
         birdTexture = new Texture("../assets/textures/pigeon.png");
         // birdTexture->setFiltering(GL_LINEAR_MIPMAP_LINEAR, GL_NEAREST); // Reverted
 
-        // Guard textures
-        guardUniformTexture = new Texture("../assets/textures/guard_uniform.png");
-        guardHelmetTexture = new Texture("../assets/textures/guard_helmet.png");
-        guardBootsTexture = new Texture("../assets/textures/guard_boots.png");
-
         // Tree textures
         treeBarkTexture = new Texture("../assets/textures/tree_bark.png");
         treeLeavesTexture = new Texture("../assets/textures/tree_leaves.png");
@@ -891,10 +1217,17 @@ int main()
 
         // Sky Dome
         skyDome = Primitives::createSphere(1.0f, 32, 32);
+        skyDome->castsShadow = false;
 
         // Central pathway to Lang Bac entrance (stone)
         pathway = Primitives::createBox(12.0f, 0.02f, 60.0f);
 
+        // Stair carpet (8 wide, 0.05 tall, 3 deep), walkway (200 x 20, tiled
+        // 20 x 2 to keep the texture square) and grandstand tiers (60 long)
+        carpet = Primitives::createBox(8.0f, 0.05f, 3.0f);
+        walkway = Primitives::createPlane(200.0f, 20.0f, 20.0f, 2.0f);
+        grandstandTier = Primitives::createBox(60.0f, 2.0f, 10.0f);
+
         // Checkerboard Grass Field (Expanded to cover whole scene)
         // Create grass patches (10x10m) with gaps (1.5m)
         // DISABLED - No grass patches per user request
@@ -961,14 +1294,12 @@ int main()
             lights.push_back(new StreetLight(glm::vec3(80.0f, 0.0f, z)));  // Outer Right
         }
 
-        // Create Guards - Standing at attention at entrance
-        guards.push_back(new Guard(glm::vec3(-6.0f, 0.0f, 0.0f), 180.0f)); // Left guard facing outward
-        guards.push_back(new Guard(glm::vec3(6.0f, 0.0f, 0.0f), 180.0f));  // Right guard facing outward
+        lightClusters = new LightClusters();
+        lightClusters->initRendering();
 
-        birds.push_back(new Bird(glm::vec3(0.0f, 20.0f, -10.0f), 30.0f, 0.0f));
-        birds.push_back(new Bird(glm::vec3(0.0f, 25.0f, -10.0f), 35.0f, 3.14f));
-        // Reduced to 2 birds as requested
-        // birds.push_back(new Bird(glm::vec3(0.0f, 18.0f, -10.0f), 25.0f, 1.57f));
+        // Create Guards - Standing at attention at entrance
+        animation->addGuard(glm::vec3(-6.0f, 0.0f, 0.0f), 180.0f); // Left guard facing outward
+        animation->addGuard(glm::vec3(6.0f, 0.0f, 0.0f), 180.0f);  // Right guard facing outward
 
         // Create Trees - All behind mausoleum and grandstands (Z < -15)
         // Left side trees (outer perimeter) - moved further left to avoid yard
@@ -1047,7 +1378,7 @@ int main()
             float scale = 180.0f + (rand() % 100);      // Larger scale 180-280
             float speed = 0.5f + (rand() % 10) / 10.0f; // Slow drift
 
-            clouds.push_back(new Cloud(glm::vec3(x, y, z), speed, scale));
+            animation->addCloud(glm::vec3(x, y, z), speed, scale);
         }
 
         // Layer 2: Mid-high, slightly faster (Cumulus) - 200-260 height
@@ -1059,9 +1390,15 @@ int main()
             float scale = 120.0f + (rand() % 80); // Scale 120-200
             float speed = 1.5f + (rand() % 20) / 10.0f;
 
-            clouds.push_back(new Cloud(glm::vec3(x, y, z), speed, scale));
+            animation->addCloud(glm::vec3(x, y, z), speed, scale);
         }
 
+        // Near clouds draw the puff as particles; far ones use impostors baked
+        // from it, one per cloud
+        cloudImpostors = new CloudImpostors();
+        cloudImpostors->initRendering(*animation, cloudData, CLOUD_TEXTURE_SIZE);
+        delete[] cloudData;
+
         // Fences removed as requested
 
         // Create Background Buildings (City Skyline) - ONLY BACK
@@ -1085,6 +1422,7 @@ int main()
             float xPos = x + (rand() % 8) - 4.0f;
             model = glm::translate(model, glm::vec3(xPos, h / 2.0f, zPos));
             buildingTransforms.push_back(model);
+            buildingHalfExtents.push_back(glm::vec3(w, h, d) * 0.5f);
         }
 
         // Layer 2: Z = -90 (Mid-rise buildings, 20-35m) - Less common
@@ -1103,6 +1441,7 @@ int main()
             float xPos = x + (rand() % 10) - 5.0f;
             model = glm::translate(model, glm::vec3(xPos, h / 2.0f, zPos));
             buildingTransforms.push_back(model);
+            buildingHalfExtents.push_back(glm::vec3(w, h, d) * 0.5f);
         }
 
         // Layer 3: Z = -120 (Occasional taller buildings, 35-50m) - Rare
@@ -1121,6 +1460,7 @@ int main()
             float xPos = x + (rand() % 15) - 7.5f;
             model = glm::translate(model, glm::vec3(xPos, h / 2.0f, zPos));
             buildingTransforms.push_back(model);
+            buildingHalfExtents.push_back(glm::vec3(w, h, d) * 0.5f);
         }
 
         // Add Trees to Sides (Forest effect) - DISABLED to prevent clutter
@@ -1158,260 +1498,573 @@ int main()
 
         TimeOfDay timeOfDay;
 
-        // ===== SHADOW MAP FBO SETUP =====
-        const unsigned int SHADOW_WIDTH = 1024, SHADOW_HEIGHT = 1024;
-        unsigned int depthMapFBO;
-        glGenFramebuffers(1, &depthMapFBO);
-
-        unsigned int depthMap;
-        glGenTextures(1, &depthMap);
-        glBindTexture(GL_TEXTURE_2D, depthMap);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, SHADOW_WIDTH, SHADOW_HEIGHT, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-        float borderColor[] = {1.0, 1.0, 1.0, 1.0};
-        glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
-
-        glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthMap, 0);
-        glDrawBuffer(GL_NONE);
-        glReadBuffer(GL_NONE);
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-        // Shader configuration
-        lightingShader.use();
-        lightingShader.setInt("material.diffuse", 0);
-        lightingShader.setInt("shadowMap", 1);
+        // ===== SHADOW CASCADES =====
+        shadowCascades = new ShadowCascades();
+        shadowCascades->initRendering();
+        BuildShadowCasters();
+        BuildOcclusionQueries();
 
         std::cout << "Lang Bac scene V5.0 - Visual Polish & Guards loaded!" << std::endl;
-        std::cout << "Controls: T = pause time, U = raise flag, L = lower flag" << std::endl;
-
-        // ===== RENDER LOOP =====
-        while (!glfwWindowShouldClose(window))
+        std::cout << "Controls: T = pause time, U = raise flag, L = lower flag, P = depth pre-pass, O = overdraw view, C = new cloud puff (sprite clouds)" << std::endl;
+
+        // ===== RENDER THREAD =====
+        // Owns the GL context from here on and draws published snapshots, so
+        // simulation of frame N+1 overlaps submission of frame N
+        FrameExchange frames(jobs->getThreadCount());
+        OverdrawCounter *overdrawCounter = new OverdrawCounter();
+        int overdrawFrames = 0;
+        Shader occlusionBoxShader("../shaders/occlusion_box.vs", "../shaders/shadow_mapping_depth.fs");
+        int occlusionFrames = 0;
+        long occlusionSkipped = 0;
+
+        float shownCloudPuffSeed = cloudSeed; // Render thread only
+        auto rebakePuff = std::make_shared<std::vector<unsigned char>>();
+        auto renderFrame = [&](const FrameSnapshot &frame)
         {
-            float currentFrame = static_cast<float>(glfwGetTime());
-            deltaTime = currentFrame - lastFrame;
-            lastFrame = currentFrame;
-
-            processInput(window);
-
-            // T key toggle
-            if (glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS)
+            const FrameLighting &lighting = frame.lighting;
+
+            // Screen-sized targets follow the current render scale
+            const int renderWidth = dynamicResolution->getRenderWidth();
+            const int renderHeight = dynamicResolution->getRenderHeight();
+            if (deferredRenderer)
+                deferredRenderer->resize(renderWidth, renderHeight);
+            if (volumetricClouds)
+                volumetricClouds->resize(renderWidth, renderHeight);
+            const GLuint sceneTarget = dynamicResolution->getFramebuffer();
+
+            // One upload per frame, shared by the shadow and lighting passes
+            pigeons->uploadInstances(frame.pigeonInstances);
+
+            // Occlusion results this frame's passes all go by
+            if (occlusionQueries)
+                occlusionQueries->beginFrame();
+
+            // Cloud puff seed moved (C key or time of day): redraw the texture
+            if (proceduralTextures && frame.cloudPuffSeed != shownCloudPuffSeed)
             {
-                if (currentFrame - lastTKeyPress > 0.5f)
+                CloudPuffParams cloudPuff;
+                cloudPuff.seed = frame.cloudPuffSeed;
+                SetCloudPuffUniforms(cloudPuffShader, cloudPuff);
+                if (proceduralTextures->generate(cloudPuffShader, *cloudTexture, CLOUD_TEXTURE_SIZE, CLOUD_TEXTURE_SIZE))
                 {
-                    timeOfDay.togglePause();
-                    lastTKeyPress = currentFrame;
+                    // Far clouds follow: a small mip is plenty for 128-texel
+                    // tiles, copied back without stalling (picked up below)
+                    const int size = CLOUD_TEXTURE_SIZE >> CLOUD_REBAKE_LEVEL;
+                    proceduralTextures->beginReadBack(*cloudTexture, GL_RGB, CLOUD_REBAKE_LEVEL, (size_t)size * size * 3);
                 }
+                shownCloudPuffSeed = frame.cloudPuffSeed;
             }
-            // U key raise flag
-            if (glfwGetKey(window, GLFW_KEY_U) == GLFW_PRESS)
+            if (proceduralTextures)
             {
-                if (currentFrame - lastUKeyPress > 0.5f)
+                // A puff readback has landed: rebake the impostors from it
+                const int size = CLOUD_TEXTURE_SIZE >> CLOUD_REBAKE_LEVEL;
+                rebakePuff->resize((size_t)size * size * 3);
+                if (proceduralTextures->finishReadBack(rebakePuff->data()))
                 {
-                    cotCo->raiseFlag();
-                    lastUKeyPress = currentFrame;
-                    std::cout << "Raising flag..." << std::endl;
+                    RequestImpostorRebake(rebakePuff, size);
+                    rebakePuff = std::make_shared<std::vector<unsigned char>>(); // The bake keeps the old one
                 }
             }
-            // L key lower flag
-            if (glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS)
+
+            // ====================================================
+            // 1. Render depth of scene to texture (from light's perspective)
+            // ====================================================
+            // One layer per cascade. Static casters come from the position-only
+            // list, culled against the cascade, and are redrawn only when the
+            // cascade was refitted; the moving ones go on top of a copy of
+            // that cache every frame. No textures or material uniforms here
+            for (int cascade = 0; cascade < ShadowCascades::COUNT; cascade++)
             {
-                if (currentFrame - lastLKeyPress > 0.5f)
+                const glm::mat4 &lightSpace = lighting.shadows.lightSpace[cascade];
+                shadowShader.use();
+                shadowShader.setMat4("lightSpaceMatrix", lightSpace);
+
+                if (shadowCascades->beginStaticCascade(cascade, lighting.shadows))
+                    shadowCasters->draw(shadowShader, Frustum(lightSpace));
+
+                shadowCascades->beginCascade(cascade);
+                RenderGuardShadows(shadowShader, frame);
+
+                flagDepthShader.use();
+                flagDepthShader.setMat4("lightSpaceMatrix", lightSpace);
+                RenderFlag(flagDepthShader, frame);
+
+                if (cascade < BIRD_SHADOW_CASCADES)
                 {
-                    cotCo->lowerFlag();
-                    lastLKeyPress = currentFrame;
-                    std::cout << "Lowering flag..." << std::endl;
+                    birdDepthShader.use();
+                    birdDepthShader.setMat4("lightSpaceMatrix", lightSpace);
+                    pigeons->drawShadowCasters(birdDepthShader);
                 }
             }
 
-            // Update
-            timeOfDay.update(deltaTime);
-            cotCo->update(deltaTime);
-            for (auto guard : guards)
-                guard->update(deltaTime);
-            for (auto cloud : clouds)
-                cloud->update(deltaTime);
-            for (auto bird : birds)
-                bird->update(deltaTime);
-
             // ====================================================
-            // 1. Render depth of scene to texture (from light's perspective)
+            // 2. Render scene as normal with shadow mapping
             // ====================================================
-            glm::mat4 lightProjection, lightView;
-            glm::mat4 lightSpaceMatrix;
-            float near_plane = 1.0f, far_plane = 100.0f;
+            dynamicResolution->bindTarget();
+            materialLayers->bind(MATERIAL_LAYERS_TEXTURE_UNIT);
 
-            glm::vec3 sunDir = timeOfDay.getSunDirection();
-            glm::vec3 lightPos = sunDir * 50.0f;
-            if (lightPos.y < 0)
-                lightPos.y = 10.0f;
+            // Day variants compile out point lights, spotlight and emissives
+            unsigned int baseVariant = (lighting.isNight ? (unsigned int)NIGHT_LIGHTS : 0u) | shadowQualityVariant;
 
-            lightProjection = glm::ortho(-50.0f, 50.0f, -50.0f, 50.0f, near_plane, far_plane);
-            lightView = glm::lookAt(lightPos, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-            lightSpaceMatrix = lightProjection * lightView;
+            // Pre-pass and overdraw view apply to the forward path only
+            const bool deferred = rendererPath == RENDERER_DEFERRED && deferredRenderer;
+            const bool overdrawView = frame.showOverdraw && !deferred;
 
-            shadowShader.use();
-            shadowShader.setMat4("lightSpaceMatrix", lightSpaceMatrix);
+            if (deferred)
+            {
+                // ===== DEFERRED: G-BUFFER =====
+                deferredRenderer->beginGeometryPass();
+
+                OpaquePrograms gbufferPrograms;
+                gbufferPrograms.scene.scene = &gbufferVariants.get(0);
+                gbufferPrograms.scene.windows = gbufferPrograms.scene.scene;
+                gbufferPrograms.scene.bulbs = gbufferPrograms.scene.scene;
+                if (lighting.isNight)
+                {
+                    gbufferPrograms.scene.windows = &gbufferVariants.get(BUILDING_WINDOWS);
+                    gbufferPrograms.scene.bulbs = &gbufferVariants.get(BULB_GLOW);
+                }
+                gbufferPrograms.flag = &gbufferFlagVariants.get(0);
+                gbufferPrograms.birds = &gbufferBirdVariants.get(0);
+                RenderOpaque(gbufferPrograms, frame, ApplyCameraUniforms);
 
-            glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
-            glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
-            glClear(GL_DEPTH_BUFFER_BIT);
+                deferredRenderer->endGeometryPass();
 
-            RenderScene(shadowShader);
+                // ===== DEFERRED: LIGHTING =====
+                dynamicResolution->bindTarget();
+                glClearColor(frame.skyColor.r, frame.skyColor.g, frame.skyColor.b, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+                shadowCascades->bindTexture(SHADOW_TEXTURE_UNIT);
 
-            // ====================================================
-            // 2. Render scene as normal with shadow mapping
-            // ====================================================
-            glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
-            glm::vec3 skyColor = timeOfDay.getSkyColor();
+                const glm::mat4 viewProjection = lighting.projection * lighting.view;
 
-            // Increased far plane to 2000.0f for horizon-to-horizon visibility
-            glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 2000.0f);
-            glm::mat4 view = camera.GetViewMatrix();
+                // Sun + shadow, emission and the flag spotlight
+                Shader &sunShader = deferredSunVariants.get(baseVariant);
+                ApplySceneLighting(sunShader, lighting);
+                deferredRenderer->bindGBuffer(sunShader, GBUFFER_TEXTURE_UNIT, viewProjection);
+                deferredRenderer->drawFullscreen();
 
-            // ===== RENDER SKY DOME =====
-            if (skyShader && skyDome)
+                // Street lights as volumes (the binned list is empty by day)
+                pointLightShader.use();
+                pointLightShader.setMat4("projection", lighting.projection);
+                pointLightShader.setMat4("view", lighting.view);
+                pointLightShader.setVec3("viewPos", lighting.viewPos);
+                deferredRenderer->bindGBuffer(pointLightShader, GBUFFER_TEXTURE_UNIT, viewProjection);
+                deferredRenderer->drawPointLights(pointLightShader, frame.lightGrid);
+
+                // Forward passes below depth-test against the scene
+                deferredRenderer->copyDepthTo(sceneTarget);
+            }
+            else
             {
-                glDepthMask(GL_FALSE); // Don't write to depth buffer
-                skyShader->use();
-                skyShader->setMat4("projection", projection);
-                skyShader->setMat4("view", view);
+                glm::vec3 clearColor = overdrawView ? glm::vec3(0.0f) : frame.skyColor;
+                glClearColor(clearColor.r, clearColor.g, clearColor.b, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+                // ===== DEPTH PRE-PASS =====
+                // Depth only, so the lighting pass below shades each visible
+                // pixel once instead of once per overlapping surface
+                if (frame.depthPrepass)
+                {
+                    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+                    OpaquePrograms prepassPrograms = {{&prepassShader, &prepassShader, &prepassShader},
+                                                      &flagPrepassShader,
+                                                      &birdPrepassShader};
+                    RenderOpaque(prepassPrograms, frame, ApplyCameraUniforms);
+                    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+                    glDepthFunc(GL_EQUAL);
+                    glDepthMask(GL_FALSE);
+                }
 
-                glm::mat4 model = glm::mat4(1.0f);
-                model = glm::translate(model, camera.Position); // Sky dome follows camera
-                model = glm::scale(model, glm::vec3(200.0f));   // Large scale
-                skyShader->setMat4("model", model);
+                shadowCascades->bindTexture(SHADOW_TEXTURE_UNIT);
 
-                skyShader->setVec3("topColor", glm::vec3(0.1f, 0.3f, 0.7f));    // Realistic Deep Blue Zenith
-                skyShader->setVec3("bottomColor", glm::vec3(0.7f, 0.8f, 0.9f)); // Hazy Horizon Blue
-                skyShader->setFloat("time", currentFrame);
-                skyShader->setBool("isNight", timeOfDay.isNightTime());
+                lightClusters->upload(frame.lightGrid);
+                lightClusters->bindTextures(CLUSTER_TEXTURE_UNIT);
 
-                // Cull front face because we are inside the sphere
-                glCullFace(GL_FRONT);
-                skyDome->draw();
-                glCullFace(GL_BACK); // Reset
+                if (overdrawView)
+                {
+                    // Every fragment that reaches the lighting shader adds up
+                    glEnable(GL_BLEND);
+                    glBlendFunc(GL_ONE, GL_ONE);
+                    OpaquePrograms overdrawPrograms = {{&overdrawShader, &overdrawShader, &overdrawShader},
+                                                       &flagOverdrawShader,
+                                                       &birdOverdrawShader};
+                    overdrawCounter->begin();
+                    RenderOpaque(overdrawPrograms, frame, ApplyCameraUniforms);
+                    overdrawCounter->end();
+                    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+                    GLuint64 samples;
+                    if (++overdrawFrames % OVERDRAW_REPORT_FRAMES == 0 && overdrawCounter->getSamples(samples))
+                    {
+                        std::cout << "Overdraw: " << (double)samples / (renderWidth * renderHeight)
+                                  << " shaded fragments per pixel (depth pre-pass "
+                                  << (frame.depthPrepass ? "on" : "off") << ")" << std::endl;
+                    }
+                }
+                else
+                {
+                    OpaquePrograms litPrograms;
+                    litPrograms.scene.scene = &lightingVariants.get(baseVariant);
+                    litPrograms.scene.windows = litPrograms.scene.scene;
+                    litPrograms.scene.bulbs = litPrograms.scene.scene;
+                    if (lighting.isNight)
+                    {
+                        litPrograms.scene.windows = &lightingVariants.get(baseVariant | BUILDING_WINDOWS);
+                        litPrograms.scene.bulbs = &lightingVariants.get(baseVariant | BULB_GLOW);
+                    }
+                    litPrograms.flag = &flagVariants.get(baseVariant);
+                    litPrograms.birds = &birdVariants.get(baseVariant);
+                    RenderOpaque(litPrograms, frame, ApplySceneLighting);
+                }
 
+                glDepthFunc(GL_LESS);
                 glDepthMask(GL_TRUE);
             }
 
-            glClearColor(skyColor.r, skyColor.g, skyColor.b, 1.0f);
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-            lightingShader.use();
-            lightingShader.setMat4("projection", projection);
-            lightingShader.setMat4("view", view);
-            lightingShader.setVec3("viewPos", camera.Position);
-            lightingShader.setMat4("lightSpaceMatrix", lightSpaceMatrix);
+            // ===== OCCLUSION QUERIES =====
+            // Boxes against the finished depth; next frame's draws of these
+            // objects are conditional on the results
+            if (occlusionQueries)
+            {
+                occlusionQueries->issue(occlusionBoxShader, lighting.projection * lighting.view, lighting.viewPos,
+                                        CAMERA_NEAR * 2.0f);
+                occlusionSkipped += occlusionQueries->getSkippedCount();
+                if (++occlusionFrames % OCCLUSION_REPORT_FRAMES == 0)
+                {
+                    std::cout << "Occlusion culling: " << (double)occlusionSkipped / OCCLUSION_REPORT_FRAMES
+                              << " of " << occlusionQueries->size() << " objects skipped per frame (last frame "
+                              << occlusionQueries->getSkippedCount() << " of " << occlusionQueries->getTestedCount()
+                              << " tested)" << std::endl;
+                    occlusionSkipped = 0;
+                }
+            }
 
-            lightingShader.setFloat("material.shininess", 32.0f);
+            // ===== RENDER SKY DOME =====
+            // After the opaque pass: sky.vs puts the dome on the far plane, so
+            // with GL_LEQUAL only pixels no geometry covered run sky.fs
+            if (skyShader && skyDome && !overdrawView)
+            {
+                glDepthFunc(GL_LEQUAL);
+                glDepthMask(GL_FALSE);
+                skyShader->use();
+                skyShader->setMat4("projection", lighting.projection);
+                skyShader->setMat4("view", lighting.view);
+
+                // Horizon matches the time-of-day sky colour, the zenith is a deeper blue of it
+                skyShader->setVec3("topColor", frame.skyColor * glm::vec3(0.4f, 0.6f, 0.9f));
+                skyShader->setVec3("bottomColor", frame.skyColor);
+                skyShader->setFloat("time", lighting.time);
+                skyShader->setBool("isNight", lighting.isNight);
+                skyDome->draw();
 
-            lightingShader.setVec3("dirLight.direction", sunDir);
+                glDepthMask(GL_TRUE);
+                glDepthFunc(GL_LESS);
+            }
 
-            glm::vec3 sunColor = glm::vec3(1.0f);
-            float ambientStrength = timeOfDay.getAmbientStrength();
-            if (timeOfDay.isNightTime())
+            // ===== RENDER CLOUDS =====
+            if (volumetricClouds && !overdrawView)
             {
-                sunColor = glm::vec3(0.2f, 0.2f, 0.3f); // Slightly brighter moonlight
-                ambientStrength = 0.25f;                // Increased from 0.1 for better visibility
+                // Raymarched at quarter resolution against a copy of the scene depth
+                volumetricClouds->captureDepth(sceneTarget);
+                cloudMarchShader.use();
+                cloudMarchShader.setVec3("sunDir", glm::normalize(lighting.sunDir));
+                cloudMarchShader.setVec3("skyColor", frame.skyColor);
+                cloudMarchShader.setFloat("time", lighting.time);
+                cloudMarchShader.setFloat("coverage", CLOUD_COVERAGE);
+                volumetricClouds->march(cloudMarchShader, lighting.projection * lighting.view, lighting.viewPos, CLOUD_TEXTURE_UNIT);
+                volumetricClouds->composite(cloudCompositeShader, sceneTarget, CLOUD_TEXTURE_UNIT);
             }
-            else if (skyColor.r > 0.7f)
+            else if (cloudShader && cloudTexture && !overdrawView)
             {
-                sunColor = glm::vec3(1.0f, 0.6f, 0.3f);
+                // Impostors and soft particles, already sorted back to front
+                cloudShader->use();
+                cloudShader->setMat4("projection", lighting.projection);
+                cloudShader->setMat4("view", lighting.view);
+                cloudShader->setVec3("viewPos", lighting.viewPos);
+                cloudShader->setFloat("time", lighting.time);
+                cloudShader->setVec3("skyColor", frame.skyColor); // Pass sky color for time-based cloud coloring
+
+                glEnable(GL_BLEND);
+                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                glDepthMask(GL_FALSE); // Disable depth writing for transparent clouds
+
+                cloudImpostors->upload(frame.cloudSprites);
+                cloudImpostors->draw(*cloudShader, cloudTexture, CLOUD_TEXTURE_UNIT);
+
+                glDepthMask(GL_TRUE); // Re-enable depth writing
+                glDisable(GL_BLEND);
             }
-            lightingShader.setVec3("dirLight.ambient", sunColor * ambientStrength);
-            lightingShader.setVec3("dirLight.diffuse", sunColor * 0.8f);
-            lightingShader.setVec3("dirLight.specular", sunColor * 0.5f);
 
-            glm::vec3 streetLightColor = glm::vec3(0.0f);
-            if (timeOfDay.isNightTime())
-                streetLightColor = glm::vec3(1.0f, 0.9f, 0.5f);
+            // ===== UPSCALE TO THE WINDOW =====
+            dynamicResolution->present(upscaleShader, UPSCALE_TEXTURE_UNIT);
+        };
 
-            // Use ALL 18 lights for complete coverage including middle area (Z=70)
-            for (int i = 0; i < 18; i++)
+        // Paths in RendererPath order
+        RenderBenchmark *rendererBenchmark = nullptr;
+        if (benchRenderer)
+        {
+            rendererBenchmark = new RenderBenchmark({"forward", "deferred"}, RENDER_BENCH_WARMUP_FRAMES, RENDER_BENCH_FRAMES);
+            timeOfDay.setTime(0.0f); // Midnight: street lights, spotlight and windows all on
+            timeOfDay.setSpeed(0.0f);
+        }
+
+        if (lowLatency && maxFramesInFlight == 0)
+            maxFramesInFlight = 1;
+        FramePacer *framePacer = new FramePacer(maxFramesInFlight, rendererBenchmark ? 0 : FRAME_PACING_REPORT_FRAMES);
+
+        glfwMakeContextCurrent(nullptr); // Hand the context over
+        std::thread renderThread([&]()
+                                 {
+                                     glfwMakeContextCurrent(window);
+                                     // The benchmark times the frames, not the display
+                                     glfwSwapInterval(rendererBenchmark ? 0 : swapInterval);
+
+                                     while (const FrameSnapshot *frame = frames.acquireLatest())
+                                     {
+                                         if (rendererBenchmark)
+                                         {
+                                             rendererPath = static_cast<RendererPath>(rendererBenchmark->currentPath());
+                                             rendererBenchmark->beginFrame();
+                                         }
+
+                                         textureStreamer->update();
+                                         dynamicResolution->beginFrame(framebufferWidth, framebufferHeight);
+                                         renderFrame(*frame);
+                                         dynamicResolution->endFrame();
+
+                                         if (rendererBenchmark)
+                                         {
+                                             rendererBenchmark->endFrame();
+                                             if (rendererBenchmark->isFinished())
+                                                 glfwSetWindowShouldClose(window, true);
+                                         }
+                                         glfwSwapBuffers(window);
+                                         framePacer->endFrame(frame->inputTime);
+                                     }
+                                     glfwMakeContextCurrent(nullptr);
+                                 });
+
+        // ===== SIMULATION LOOP =====
+        // Fixed 60 Hz steps; rendering blends the last two steps
+        SimulationClock simClock;
+        float prevFlagWaveTime = cotCo->getWaveTime();
+        float prevFlagRaise = cotCo->getFlagRaise();
+        FrameLimiter frameLimiter(rendererBenchmark ? 0.0f : fpsLimit);
+        double inputTime = FramePacer::now(); // When events were last polled
+
+        while (!glfwWindowShouldClose(window))
+        {
+            frameLimiter.wait();
+            if (lowLatency)
             {
-                std::string number = std::to_string(i);
-                lightingShader.setVec3("pointLights[" + number + "].position", lights[i]->getLightPosition() + glm::vec3(0, -0.5f, 0));
-                lightingShader.setVec3("pointLights[" + number + "].ambient", streetLightColor * 0.1f);
-                lightingShader.setVec3("pointLights[" + number + "].diffuse", streetLightColor * 1.5f);
-                lightingShader.setVec3("pointLights[" + number + "].specular", streetLightColor * 1.0f);
-                lightingShader.setFloat("pointLights[" + number + "].constant", 1.0f);
-                lightingShader.setFloat("pointLights[" + number + "].linear", 0.09f);
-                lightingShader.setFloat("pointLights[" + number + "].quadratic", 0.032f);
+                // Input as fresh as possible: poll only when the frame built
+                // from it can be drawn straight away
+                frames.waitUntilWanted();
+                glfwPollEvents();
+                inputTime = FramePacer::now();
             }
 
-            lightingShader.setVec3("spotLight.position", cotCo->position + glm::vec3(0.0f, 0.5f, 2.0f));
-            lightingShader.setVec3("spotLight.direction", glm::vec3(0.0f, 1.0f, -0.2f));
-            lightingShader.setFloat("spotLight.cutOff", glm::cos(glm::radians(12.5f)));
-            lightingShader.setFloat("spotLight.outerCutOff", glm::cos(glm::radians(17.5f)));
-            lightingShader.setFloat("spotLight.constant", 1.0f);
-            lightingShader.setFloat("spotLight.linear", 0.09f);
-            lightingShader.setFloat("spotLight.quadratic", 0.032f);
+            float currentFrame = static_cast<float>(glfwGetTime());
+            deltaTime = currentFrame - lastFrame;
+            lastFrame = currentFrame;
+
+            processInput(window);
 
-            if (timeOfDay.isNightTime())
+            // T key toggle
+            if (glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS)
             {
-                lightingShader.setVec3("spotLight.ambient", glm::vec3(0.0f));
-                lightingShader.setVec3("spotLight.diffuse", glm::vec3(1.0f));
-                lightingShader.setVec3("spotLight.specular", glm::vec3(1.0f));
+                if (currentFrame - lastTKeyPress > 0.5f)
+                {
+                    timeOfDay.togglePause();
+                    lastTKeyPress = currentFrame;
+                }
             }
-            else
+            // U key raise flag
+            if (glfwGetKey(window, GLFW_KEY_U) == GLFW_PRESS)
+            {
+                if (currentFrame - lastUKeyPress > 0.5f)
+                {
+                    cotCo->raiseFlag();
+                    lastUKeyPress = currentFrame;
+                    std::cout << "Raising flag..." << std::endl;
+                }
+            }
+            // L key lower flag
+            if (glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS)
             {
-                lightingShader.setVec3("spotLight.ambient", glm::vec3(0.0f));
-                lightingShader.setVec3("spotLight.diffuse", glm::vec3(0.0f));
-                lightingShader.setVec3("spotLight.specular", glm::vec3(0.0f));
+                if (currentFrame - lastLKeyPress > 0.5f)
+                {
+                    cotCo->lowerFlag();
+                    lastLKeyPress = currentFrame;
+                    std::cout << "Lowering flag..." << std::endl;
+                }
             }
-
-            glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D, depthMap);
-
-            // Set uniforms for building window lights
-            lightingShader.setBool("isNight", timeOfDay.isNightTime());
-            lightingShader.setFloat("time", currentFrame);
-            lightingShader.setBool("enableWindowLights", false); // Disable by default
-            lightingShader.setBool("enableBulbGlow", false);     // Will be enabled specifically for bulbs
-
-            lightingShader.setFloat("material.shininess", 4.0f);
-            RenderScene(lightingShader, timeOfDay.isNightTime());
-
-            // ===== RENDER VOLUMETRIC CLOUDS =====
-            if (cloudShader && cloudTexture)
+            // P key depth pre-pass
+            if (glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS)
             {
-                cloudShader->use();
-                cloudShader->setMat4("projection", projection);
-                cloudShader->setMat4("view", view);
-                cloudShader->setVec3("viewPos", camera.Position);
-                cloudShader->setFloat("time", currentFrame);
-                cloudShader->setInt("cloudTexture", 0);
-                cloudShader->setVec3("skyColor", skyColor); // Pass sky color for time-based cloud coloring
-
-                cloudTexture->bind(0);
-                glEnable(GL_BLEND);
-                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-                glDepthMask(GL_FALSE); // Disable depth writing for transparent clouds
+                if (currentFrame - lastPKeyPress > 0.5f)
+                {
+                    depthPrepass = !depthPrepass;
+                    lastPKeyPress = currentFrame;
+                    std::cout << "Depth pre-pass " << (depthPrepass ? "on" : "off") << std::endl;
+                }
+            }
+            // O key overdraw view
+            if (glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS)
+            {
+                if (currentFrame - lastOKeyPress > 0.5f)
+                {
+                    showOverdraw = !showOverdraw;
+                    lastOKeyPress = currentFrame;
+                }
+            }
 
-                // Render each cloud's spheres
-                for (auto cloud : clouds)
+            // C key new cloud puff, only shown by sprite clouds (the GPU path
+            // picks the seed up from the snapshot; the CPU one fills it
+            // off-thread and uploads it via PBO, then rebakes the impostors
+            // from the same pixels)
+            if (glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS && cloudPath == CLOUDS_SPRITES)
+            {
+                if (currentFrame - lastCKeyPress > 0.5f)
                 {
-                    int sphereCount = cloud->getSphereCount();
-                    for (int i = 0; i < sphereCount; i++)
+                    cloudSeed += CLOUD_SEED_STEP;
+                    if (!gpuCloudTexture)
                     {
-                        glm::mat4 modelCloud = cloud->getTransform(i);
-                        cloudShader->setMat4("model", modelCloud);
-                        cloud->spheres[i]->draw();
+                        CloudPuffParams params;
+                        params.seed = cloudSeed;
+                        textureStreamer->request(cloudTexture->ID, CLOUD_TEXTURE_SIZE, CLOUD_TEXTURE_SIZE, GL_RGB,
+                                                 [params](unsigned char *pixels)
+                                                 {
+                                                     // The mapping is write-only, so keep a copy for the bake
+                                                     const size_t bytes = (size_t)CLOUD_TEXTURE_SIZE * CLOUD_TEXTURE_SIZE * 3;
+                                                     auto puff = std::make_shared<std::vector<unsigned char>>(bytes);
+                                                     GenerateCloudTexture(puff->data(), CLOUD_TEXTURE_SIZE, params, nullptr);
+                                                     std::memcpy(pixels, puff->data(), bytes);
+                                                     RequestImpostorRebake(puff, CLOUD_TEXTURE_SIZE);
+                                                 });
                     }
+                    lastCKeyPress = currentFrame;
                 }
+            }
 
-                glDepthMask(GL_TRUE); // Re-enable depth writing
-                glDisable(GL_BLEND);
+            // Update: whole steps only, however long the frame was
+            simClock.advance(deltaTime);
+            while (simClock.step())
+            {
+                const float step = simClock.getStep();
+                prevFlagWaveTime = cotCo->getWaveTime();
+                prevFlagRaise = cotCo->getFlagRaise();
+
+                timeOfDay.update(step);
+                cotCo->update(step);
+
+                JobSystem::Counter stepJobs;
+                jobs->run([step]()
+                          { animation->update(step); },
+                          stepJobs);
+                pigeons->update(step, jobs); // parallel_for inside
+                jobs->wait(stepJobs);
             }
-            glfwSwapBuffers(window);
-            glfwPollEvents();
+            const float alpha = simClock.getAlpha();
+
+            FrameSnapshot &frame = frames.beginWrite();
+            FrameLighting &lighting = frame.lighting;
+            frame.inputTime = inputTime;
+
+            // Frame matrices (the culling jobs need every frustum)
+            // Increased far plane to 2000.0f for horizon-to-horizon visibility
+            const float fovY = glm::radians(camera.Zoom);
+            const int windowWidth = framebufferWidth, windowHeight = framebufferHeight;
+            const float aspect = windowWidth > 0 && windowHeight > 0 ? (float)windowWidth / (float)windowHeight
+                                                                     : (float)SCR_WIDTH / (float)SCR_HEIGHT;
+            lighting.projection = glm::perspective(fovY, aspect, CAMERA_NEAR, CAMERA_FAR);
+            lighting.view = camera.GetViewMatrix();
+
+            // Shadow casting direction: keep the sun (or moon) above the horizon
+            glm::vec3 sunDir = timeOfDay.getSunDirection();
+            glm::vec3 toLight = sunDir;
+            if (toLight.y < 0.2f)
+                toLight.y = 0.2f;
+            shadowCascades->fit(lighting.view, fovY, aspect, CAMERA_NEAR, glm::normalize(toLight), lighting.shadows);
+            lighting.viewPos = camera.Position;
+            lighting.sunDir = sunDir;
+            lighting.isNight = timeOfDay.isNightTime();
+            lighting.time = simClock.getInterpolatedTime();
+
+            frame.skyColor = timeOfDay.getSkyColor();
+            frame.depthPrepass = depthPrepass;
+            frame.showOverdraw = showOverdraw;
+            frame.cloudPuffSeed = cloudSeed;
+            if (gpuCloudTexture && cloudPath == CLOUDS_SPRITES)
+                frame.cloudPuffSeed += std::floor(timeOfDay.getTime() * CLOUD_DRIFT_STEPS) * (CLOUD_DAY_DRIFT / CLOUD_DRIFT_STEPS);
+            lighting.sunColor = glm::vec3(1.0f);
+            lighting.ambientStrength = timeOfDay.getAmbientStrength();
+            if (lighting.isNight)
+            {
+                lighting.sunColor = glm::vec3(0.2f, 0.2f, 0.3f); // Slightly brighter moonlight
+                lighting.ambientStrength = 0.25f;                // Increased from 0.1 for better visibility
+            }
+            else if (frame.skyColor.r > 0.7f)
+            {
+                lighting.sunColor = glm::vec3(1.0f, 0.6f, 0.3f);
+            }
+
+            frame.flagWaveTime = glm::mix(prevFlagWaveTime, cotCo->getWaveTime(), alpha);
+            frame.flagRaise = glm::mix(prevFlagRaise, cotCo->getFlagRaise(), alpha);
+
+            // ===== FRAME JOBS =====
+            // Interpolated transforms, culling/LOD and queue building spread
+            // over all cores; the render thread only submits the prepared draws
+            JobSystem::Counter frameJobs;
+            jobs->run([&]()
+                      {
+                          animation->writeTransforms(alpha); // Part matrices for both passes
+                          frame.guardTransforms = animation->getAllGuardTransforms();
+                          if (cloudPath == CLOUDS_SPRITES)
+                              cloudImpostors->build(*animation, lighting.view, lighting.viewPos, frame.cloudSprites);
+                      },
+                      frameJobs);
+            jobs->run([&]()
+                      {
+                          std::vector<LightClusters::PointLight> pointLights = GatherPointLights(lighting.isNight);
+                          lightClusters->bin(pointLights, lighting.view, fovY, aspect, CAMERA_FAR, frame.lightGrid);
+                      },
+                      frameJobs);
+            jobs->run([&]()
+                      { BuildSceneQueue(frame.cameraQueue, Frustum(lighting.projection * lighting.view), lighting.viewPos); },
+                      frameJobs);
+
+            pigeons->writeInstances(alpha);
+            frame.pigeonInstances = pigeons->getInstances();
+            jobs->wait(frameJobs);
+
+            // Waits while the render thread has not picked up the previous frame
+            frames.publish();
+            if (!lowLatency)
+            {
+                glfwPollEvents();
+                inputTime = FramePacer::now();
+            }
+        }
+
+        frames.close();
+        renderThread.join();
+        glfwMakeContextCurrent(window); // Cleanup below deletes GL objects
+
+        if (rendererBenchmark)
+        {
+            rendererBenchmark->printResults();
+            delete rendererBenchmark;
         }
+        delete framePacer;
+        delete deferredRenderer;
+        delete dynamicResolution;
+        delete overdrawCounter;
+        delete textureStreamer; // Before the textures it uploads to
+        delete proceduralTextures;
 
         delete skyDome;
         delete skyShader;
@@ -1421,17 +2074,23 @@ int main()
         delete sharedGrassPatch;
         grassTransforms.clear();
         delete pathway;
+        delete carpet;
+        delete walkway;
+        delete grandstandTier;
         // grassGridLines removed
         delete langBac;
         delete cotCo;
         for (auto light : lights)
             delete light;
-        for (auto guard : guards)
-            delete guard;
-        for (auto cloud : clouds)
-            delete cloud;
-        for (auto bird : birds)
-            delete bird;
+        delete lightClusters;
+        delete shadowCascades;
+        delete shadowCasters;
+        delete occlusionQueries;
+        delete cloudImpostors;
+        delete volumetricClouds;
+        delete animation;
+        delete pigeons;
+        delete jobs; // Joins the worker threads
 
         delete grassTexture;
         delete stoneTexture;
@@ -1440,14 +2099,11 @@ int main()
         delete metalTexture;
         delete cloudTexture;
         delete birdTexture;
-        delete guardUniformTexture;
-        delete guardHelmetTexture;
-        delete guardBootsTexture;
+        delete materialLayers;
         delete treeBarkTexture;
         delete treeLeavesTexture;
 
         // Duplicate deletions removed
-        guards.clear();
         trees.clear();
         redFlags.clear();
 
@@ -1485,7 +2141,10 @@ void processInput(GLFWwindow *window)
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height)
 {
-    glViewport(0, 0, width, height);
+    // No GL calls here: the context belongs to the render thread, which
+    // resizes its targets and viewport from these at the start of each frame
+    framebufferWidth = width;
+    framebufferHeight = height;
 }
 
 void mouse_callback(GLFWwindow *window, double xposIn, double yposIn)
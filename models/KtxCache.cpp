@@ -0,0 +1,223 @@
+#include "KtxCache.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const unsigned char KTX_IDENTIFIER[12] = {0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'};
+    const uint32_t KTX_ENDIANNESS = 0x04030201;
+
+    struct KtxHeader
+    {
+        unsigned char identifier[12];
+        uint32_t endianness;
+        uint32_t glType, glTypeSize, glFormat; // 0, 1, 0 for compressed data
+        uint32_t glInternalFormat, glBaseInternalFormat;
+        uint32_t pixelWidth, pixelHeight, pixelDepth;
+        uint32_t numberOfArrayElements, numberOfFaces, numberOfMipmapLevels;
+        uint32_t bytesOfKeyValueData;
+    };
+
+    // Read-only view of a whole file; data() is null if it could not be mapped
+    class MappedFile
+    {
+    public:
+        explicit MappedFile(const std::string &path)
+            : bytes(nullptr), length(0)
+        {
+#ifdef _WIN32
+            file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+            mapping = NULL;
+            LARGE_INTEGER fileSize;
+            if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+                return;
+            mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (mapping)
+            {
+                bytes = static_cast<const unsigned char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                length = bytes ? (size_t)fileSize.QuadPart : 0;
+            }
+#else
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+                return;
+            struct stat info;
+            if (fstat(fd, &info) == 0 && info.st_size > 0)
+            {
+                void *view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (view != MAP_FAILED)
+                {
+                    bytes = static_cast<const unsigned char *>(view);
+                    length = (size_t)info.st_size;
+                }
+            }
+            close(fd); // The mapping keeps the file open
+#endif
+        }
+
+        ~MappedFile()
+        {
+#ifdef _WIN32
+            if (bytes)
+                UnmapViewOfFile(bytes);
+            if (mapping)
+                CloseHandle(mapping);
+            if (file != INVALID_HANDLE_VALUE)
+                CloseHandle(file);
+#else
+            if (bytes)
+                munmap(const_cast<unsigned char *>(bytes), length);
+#endif
+        }
+
+        const unsigned char *data() const { return bytes; }
+        size_t size() const { return length; }
+
+    private:
+        const unsigned char *bytes;
+        size_t length;
+#ifdef _WIN32
+        HANDLE file, mapping;
+#endif
+    };
+
+    bool driverSupports(GLenum internalFormat)
+    {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &count);
+        std::vector<GLint> formats(std::max(0, count));
+        if (count > 0)
+            glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+        return std::find(formats.begin(), formats.end(), (GLint)internalFormat) != formats.end();
+    }
+}
+
+bool KtxCache::isFresh(const std::string &cachePath, const std::string &sourcePath)
+{
+    struct stat cache, source;
+    if (stat(cachePath.c_str(), &cache) != 0)
+        return false;
+    // A cache without its source (shipped on its own) is still usable
+    return stat(sourcePath.c_str(), &source) != 0 || cache.st_mtime >= source.st_mtime;
+}
+
+bool KtxCache::load(const std::string &path, int &width, int &height)
+{
+    MappedFile file(path);
+    if (!file.data() || file.size() < sizeof(KtxHeader))
+        return false;
+
+    KtxHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.identifier, KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER)) != 0 ||
+        header.endianness != KTX_ENDIANNESS || header.glType != 0 || header.glFormat != 0 ||
+        header.pixelDepth != 0 || header.numberOfArrayElements != 0 || header.numberOfFaces != 1 ||
+        header.numberOfMipmapLevels == 0 || header.pixelWidth == 0 || header.pixelHeight == 0)
+        return false;
+    if (!driverSupports(header.glInternalFormat))
+        return false;
+
+    // Check every level fits before uploading any of them
+    std::vector<size_t> offsets, sizes;
+    size_t offset = sizeof(KtxHeader) + header.bytesOfKeyValueData;
+    for (uint32_t level = 0; level < header.numberOfMipmapLevels; level++)
+    {
+        uint32_t imageSize;
+        if (offset + sizeof(imageSize) > file.size())
+            return false;
+        std::memcpy(&imageSize, file.data() + offset, sizeof(imageSize));
+        offset += sizeof(imageSize);
+        if (offset + imageSize > file.size())
+            return false;
+        offsets.push_back(offset);
+        sizes.push_back(imageSize);
+        offset += (imageSize + 3) & ~3u; // mipPadding
+    }
+
+    width = (int)header.pixelWidth;
+    height = (int)header.pixelHeight;
+    int levelWidth = width, levelHeight = height;
+    for (size_t level = 0; level < offsets.size(); level++)
+    {
+        glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)level, header.glInternalFormat, levelWidth, levelHeight, 0,
+                               (GLsizei)sizes[level], file.data() + offsets[level]);
+        levelWidth = std::max(1, levelWidth / 2);
+        levelHeight = std::max(1, levelHeight / 2);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)offsets.size() - 1);
+    return true;
+}
+
+bool KtxCache::save(const std::string &path)
+{
+    GLint compressed = GL_FALSE;
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_COMPRESSED, &compressed);
+    if (!compressed)
+        return false;
+
+    GLint internalFormat, width, height, greenSize, alphaSize;
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &internalFormat);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_GREEN_SIZE, &greenSize);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_ALPHA_SIZE, &alphaSize);
+
+    // Levels the texture actually has (an unspecified level reports width 0)
+    uint32_t levels = 0;
+    for (GLint levelWidth = width; levelWidth > 0; levels++)
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, (GLint)levels + 1, GL_TEXTURE_WIDTH, &levelWidth);
+
+    KtxHeader header = {};
+    std::memcpy(header.identifier, KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER));
+    header.endianness = KTX_ENDIANNESS;
+    header.glTypeSize = 1;
+    header.glInternalFormat = (uint32_t)internalFormat;
+    header.glBaseInternalFormat = alphaSize > 0 ? GL_RGBA : greenSize > 0 ? GL_RGB : GL_RED;
+    header.pixelWidth = (uint32_t)width;
+    header.pixelHeight = (uint32_t)height;
+    header.numberOfFaces = 1;
+    header.numberOfMipmapLevels = levels;
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+        return false;
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    std::vector<unsigned char> image;
+    const char padding[3] = {0, 0, 0};
+    for (uint32_t level = 0; level < levels; level++)
+    {
+        GLint imageSize = 0;
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, (GLint)level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &imageSize);
+        image.resize((size_t)imageSize);
+        glGetCompressedTexImage(GL_TEXTURE_2D, (GLint)level, image.data());
+
+        uint32_t size = (uint32_t)imageSize;
+        out.write(reinterpret_cast<const char *>(&size), sizeof(size));
+        out.write(reinterpret_cast<const char *>(image.data()), imageSize);
+        out.write(padding, (4 - imageSize % 4) % 4);
+    }
+
+    out.close();
+    if (!out)
+    {
+        std::remove(path.c_str()); // Never leave a truncated cache behind
+        return false;
+    }
+    return true;
+}
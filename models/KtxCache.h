@@ -0,0 +1,28 @@
+#ifndef KTXCACHE_H
+#define KTXCACHE_H
+
+#include <glad/glad.h>
+#include <string>
+
+/**
+ * On-disk cache of GPU-compressed textures (KTX 1.1 files)
+ * save() writes every mip level of a texture the driver has compressed
+ * (glGetCompressedTexImage), in whichever compressed format it picked for
+ * the generic GL_COMPRESSED_* request. load() memory-maps such a file and
+ * hands the levels straight to glCompressedTexImage2D: no image decode and
+ * no mipmap generation at startup. Both work on the texture bound to
+ * GL_TEXTURE_2D.
+ */
+namespace KtxCache
+{
+    // Cache file exists and is newer than the image it was made from
+    bool isFresh(const std::string &cachePath, const std::string &sourcePath);
+
+    // False if the file is missing, malformed or in a format this driver lacks
+    bool load(const std::string &path, int &width, int &height);
+
+    // False (and nothing written) if the texture is not compressed
+    bool save(const std::string &path);
+}
+
+#endif
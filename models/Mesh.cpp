@@ -7,7 +7,7 @@
  */
 
 Mesh::Mesh(std::vector<Vertex> vertices, std::vector<GLuint> indices)
-    : vertices(vertices), indices(indices), VAO(0), VBO(0), EBO(0)
+    : vertices(vertices), indices(indices), VAO(0), VBO(0), EBO(0), castsShadow(true)
 {
     setupMesh();
 }
@@ -77,3 +77,36 @@ void Mesh::draw()
     // Unbind VAO
     glBindVertexArray(0);
 }
+
+void Mesh::setInstanceAttributes(GLuint instanceBuffer, GLuint firstLocation, int vec4Count, GLsizei stride)
+{
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+
+    for (int i = 0; i < vec4Count; i++)
+    {
+        GLuint location = firstLocation + i;
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, stride, (void *)(i * sizeof(glm::vec4)));
+        glVertexAttribDivisor(location, 1); // Advance once per instance
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Mesh::drawInstanced(GLsizei instanceCount)
+{
+    glBindVertexArray(VAO);
+
+    if (!indices.empty())
+    {
+        glDrawElementsInstanced(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0, instanceCount);
+    }
+    else
+    {
+        glDrawArraysInstanced(GL_TRIANGLES, 0, vertices.size(), instanceCount);
+    }
+
+    glBindVertexArray(0);
+}
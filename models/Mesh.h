@@ -25,6 +25,9 @@ public:
     std::vector<GLuint> indices;
     GLuint VAO, VBO, EBO;
 
+    // Included in the shadow pass (off for the sky, clouds and tiny parts)
+    bool castsShadow;
+
     // Constructor
     Mesh(std::vector<Vertex> vertices, std::vector<GLuint> indices);
     ~Mesh();
@@ -32,6 +35,11 @@ public:
     // Render the mesh
     void draw();
 
+    // Instancing: bind a per-instance buffer as vec4 attributes starting at
+    // firstLocation (divisor 1), then draw instanceCount copies
+    void setInstanceAttributes(GLuint instanceBuffer, GLuint firstLocation, int vec4Count, GLsizei stride);
+    void drawInstanced(GLsizei instanceCount);
+
 private:
     void setupMesh();
 };
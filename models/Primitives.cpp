@@ -53,6 +53,49 @@ namespace Primitives
 
     return new Mesh(vertices, indices);
 }
+
+    Mesh *createGrid(float width, float height, int segmentsX, int segmentsY)
+    {
+        std::vector<Vertex> vertices;
+        std::vector<GLuint> indices;
+
+        // (segmentsX + 1) x (segmentsY + 1) vertices, facing +Z
+        for (int j = 0; j <= segmentsY; j++)
+        {
+            float v = (float)j / segmentsY;
+            for (int i = 0; i <= segmentsX; i++)
+            {
+                float u = (float)i / segmentsX;
+                vertices.push_back({
+                    glm::vec3(u * width, (v - 1.0f) * height, 0.0f), // Top edge at Y=0
+                    glm::vec3(0.0f, 0.0f, 1.0f),
+                    glm::vec2(u, v)});
+            }
+        }
+
+        // 2 triangles per cell (CCW seen from +Z)
+        int rowLength = segmentsX + 1;
+        for (int j = 0; j < segmentsY; j++)
+        {
+            for (int i = 0; i < segmentsX; i++)
+            {
+                GLuint bottomLeft = j * rowLength + i;
+                GLuint bottomRight = bottomLeft + 1;
+                GLuint topLeft = bottomLeft + rowLength;
+                GLuint topRight = topLeft + 1;
+
+                indices.push_back(bottomLeft);
+                indices.push_back(bottomRight);
+                indices.push_back(topRight);
+                indices.push_back(topRight);
+                indices.push_back(topLeft);
+                indices.push_back(bottomLeft);
+            }
+        }
+
+        return new Mesh(vertices, indices);
+    }
+
     Mesh *createBox(float width, float height, float depth)
     {
         std::vector<Vertex> vertices;
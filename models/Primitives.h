@@ -17,6 +17,14 @@ namespace Primitives
      */
     Mesh *createPlane(float width = 10.0f, float depth = 10.0f, float tilingX = 1.0f, float tilingY = -1.0f);
 
+    /**
+     * Tạo lưới đứng (mặt phẳng XY) chia nhỏ, dùng cho vải/cờ biến dạng trên GPU
+     * Gốc tọa độ ở cạnh trên bên trái: X chạy 0 -> width, Y chạy 0 -> -height
+     * @param segmentsX Số ô theo chiều ngang
+     * @param segmentsY Số ô theo chiều dọc
+     */
+    Mesh *createGrid(float width, float height, int segmentsX, int segmentsY);
+
     /**
      * Tạo một hình hộp
      * @param width Chiều rộng (X)
@@ -1,5 +1,8 @@
 #include "Texture.h"
+#include "KtxCache.h"
+#include <algorithm>
 #include <iostream>
+#include <vector>
 
 // stb_image implementation
 #define STB_IMAGE_IMPLEMENTATION
@@ -24,25 +27,88 @@ Texture::~Texture()
     }
 }
 
+namespace
+{
+    // Box-filtered mip chain down to 1x1; each level is handed to the driver
+    // as-is, so with a compressed internalFormat the driver encodes it
+    void uploadMipChain(const unsigned char *data, int width, int height, int channels, GLenum format,
+                        GLenum internalFormat)
+    {
+        std::vector<unsigned char> level(data, data + (size_t)width * height * channels);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // Small RGB levels have odd row sizes
+        for (int mip = 0;; mip++)
+        {
+            glTexImage2D(GL_TEXTURE_2D, mip, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, level.data());
+            if (width == 1 && height == 1)
+                break;
+
+            int nextWidth = std::max(1, width / 2), nextHeight = std::max(1, height / 2);
+            std::vector<unsigned char> next((size_t)nextWidth * nextHeight * channels);
+            for (int y = 0; y < nextHeight; y++)
+            {
+                int y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+                for (int x = 0; x < nextWidth; x++)
+                {
+                    int x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+                    for (int c = 0; c < channels; c++)
+                    {
+                        int sum = level[(y0 * width + x0) * channels + c] + level[(y0 * width + x1) * channels + c] +
+                                  level[(y1 * width + x0) * channels + c] + level[(y1 * width + x1) * channels + c];
+                        next[(y * nextWidth + x) * channels + c] = (unsigned char)((sum + 2) / 4);
+                    }
+                }
+            }
+            level.swap(next);
+            width = nextWidth;
+            height = nextHeight;
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+}
+
 void Texture::loadFromFile(const char *filepath, bool flip)
 {
     // Generate texture ID
     glGenTextures(1, &ID);
+    glBindTexture(GL_TEXTURE_2D, ID);
 
-    // Load image data
+    // Set texture wrapping and filtering parameters
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // Compressed mip chain cached next to the image, written on the first run
+    std::string cachePath = std::string(filepath) + (flip ? ".ktx" : ".noflip.ktx");
     int width, height, nrChannels;
+    if (KtxCache::isFresh(cachePath, filepath) && KtxCache::load(cachePath, width, height))
+    {
+        std::cout << "Texture loaded from cache: " << cachePath << " (" << width << "x" << height << ")" << std::endl;
+        return;
+    }
+
+    // Load image data
     stbi_set_flip_vertically_on_load(flip);
     unsigned char *data = stbi_load(filepath, &width, &height, &nrChannels, 0);
 
     if (data)
     {
-        GLenum format;
+        GLenum format, compressedFormat;
         if (nrChannels == 1)
+        {
             format = GL_RED;
+            compressedFormat = GL_COMPRESSED_RED;
+        }
         else if (nrChannels == 3)
+        {
             format = GL_RGB;
+            compressedFormat = GL_COMPRESSED_RGB;
+        }
         else if (nrChannels == 4)
+        {
             format = GL_RGBA;
+            compressedFormat = GL_COMPRESSED_RGBA;
+        }
         else
         {
             std::cerr << "Unsupported number of channels: " << nrChannels << std::endl;
@@ -50,20 +116,12 @@ void Texture::loadFromFile(const char *filepath, bool flip)
             return;
         }
 
-        // Bind and configure texture
-        glBindTexture(GL_TEXTURE_2D, ID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        // Set texture wrapping parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-        // Set texture filtering parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        // The driver picks the block format (BC/ETC2/...) for the generic request
+        uploadMipChain(data, width, height, nrChannels, format, compressedFormat);
+        bool cached = KtxCache::save(cachePath);
 
-        std::cout << "Texture loaded successfully: " << filepath << " (" << width << "x" << height << ", " << nrChannels << " channels)" << std::endl;
+        std::cout << "Texture loaded successfully: " << filepath << " (" << width << "x" << height << ", " << nrChannels << " channels"
+                  << (cached ? ", cached as " + cachePath : std::string(", not compressed by the driver")) << ")" << std::endl;
     }
     else
     {
@@ -0,0 +1,97 @@
+#include "TextureArray.h"
+#include "stb_image.h"
+#include <algorithm>
+#include <iostream>
+
+TextureArray::TextureArray(int size)
+    : layerSize(size), layerCount(0), ID(0)
+{
+}
+
+TextureArray::~TextureArray()
+{
+    if (ID != 0)
+        glDeleteTextures(1, &ID);
+}
+
+int TextureArray::addFile(const char *filepath, bool flipVertically)
+{
+    int width, height, nrChannels;
+    stbi_set_flip_vertically_on_load(flipVertically);
+    unsigned char *data = stbi_load(filepath, &width, &height, &nrChannels, 4);
+    if (!data)
+    {
+        std::cerr << "Failed to load texture layer: " << filepath << std::endl;
+        return -1;
+    }
+
+    // Box filter: each layer texel averages the source texels it covers
+    // (at least one, so smaller images are scaled up with nearest sampling)
+    size_t offset = pixels.size();
+    pixels.resize(offset + (size_t)layerSize * layerSize * 4);
+    for (int y = 0; y < layerSize; y++)
+    {
+        int y0 = y * height / layerSize;
+        int y1 = std::max(y0 + 1, (y + 1) * height / layerSize);
+        for (int x = 0; x < layerSize; x++)
+        {
+            int x0 = x * width / layerSize;
+            int x1 = std::max(x0 + 1, (x + 1) * width / layerSize);
+
+            unsigned int sum[4] = {0, 0, 0, 0};
+            for (int sy = y0; sy < y1; sy++)
+                for (int sx = x0; sx < x1; sx++)
+                    for (int c = 0; c < 4; c++)
+                        sum[c] += data[(sy * width + sx) * 4 + c];
+
+            unsigned int count = (unsigned int)((y1 - y0) * (x1 - x0));
+            for (int c = 0; c < 4; c++)
+                pixels[offset + (y * layerSize + x) * 4 + c] = (unsigned char)(sum[c] / count);
+        }
+    }
+    stbi_image_free(data);
+
+    std::cout << "Texture layer " << layerCount << ": " << filepath << " (" << width << "x" << height
+              << " -> " << layerSize << "x" << layerSize << ")" << std::endl;
+    return layerCount++;
+}
+
+int TextureArray::addColor(unsigned char r, unsigned char g, unsigned char b)
+{
+    size_t offset = pixels.size();
+    pixels.resize(offset + (size_t)layerSize * layerSize * 4);
+    for (size_t i = offset; i < pixels.size(); i += 4)
+    {
+        pixels[i] = r;
+        pixels[i + 1] = g;
+        pixels[i + 2] = b;
+        pixels[i + 3] = 255;
+    }
+    return layerCount++;
+}
+
+void TextureArray::upload()
+{
+    glGenTextures(1, &ID);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, ID);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, layerSize, layerSize, std::max(1, layerCount), 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, pixels.empty() ? NULL : pixels.data());
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    std::cout << "Texture array: " << layerCount << " layers of " << layerSize << "x" << layerSize << ", "
+              << pixels.size() / 1024 << " KB" << std::endl;
+    std::vector<unsigned char>().swap(pixels);
+}
+
+void TextureArray::bind(unsigned int unit) const
+{
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, ID);
+    glActiveTexture(GL_TEXTURE0);
+}
@@ -0,0 +1,37 @@
+#ifndef TEXTUREARRAY_H
+#define TEXTUREARRAY_H
+
+#include <glad/glad.h>
+#include <vector>
+
+/**
+ * Small and solid-colour textures as the layers of one GL_TEXTURE_2D_ARRAY
+ * Every layer has the same square size; images are box-filtered to it on
+ * load. Programs pick a layer per draw with the materialLayer uniform (see
+ * material.glsl), so an object made of several of these materials draws
+ * with a single binding and only an integer uniform changes between parts.
+ */
+class TextureArray
+{
+public:
+    explicit TextureArray(int layerSize);
+    ~TextureArray();
+
+    // Layer index of the new layer, or -1 if the file could not be loaded
+    int addFile(const char *filepath, bool flipVertically = true);
+    int addColor(unsigned char r, unsigned char g, unsigned char b);
+
+    // Create the GL texture with mipmaps and free the CPU copy
+    void upload();
+    void bind(unsigned int unit) const;
+
+    int getLayerCount() const { return layerCount; }
+
+private:
+    int layerSize;
+    int layerCount;
+    std::vector<unsigned char> pixels; // RGBA, one layer after another
+    GLuint ID;
+};
+
+#endif
@@ -6,8 +6,9 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 /**
- * Flying bird (pigeon) with wing flapping animation
- * Flies in circular path around a center point
+ * Pigeon model with wing flapping animation
+ * Geometry is shared by every bird; per-bird flight state (boids steering,
+ * landing state machine) lives in Flock as struct-of-arrays.
  */
 class Bird
 {
@@ -19,44 +20,29 @@ public:
         TAKING_OFF
     };
 
-    Mesh *body;
-    Mesh *head;
-    Mesh *beak;
-    Mesh *tail;
-    Mesh *wingLeft;
-    Mesh *wingRight;
+    // Mesh parts (one instanced draw each)
+    enum Part {
+        BODY,
+        HEAD,
+        BEAK,
+        TAIL,
+        WING_LEFT,
+        WING_RIGHT,
+        PART_COUNT
+    };
 
-    Bird(glm::vec3 centerPos, float radius, float startAngle = 0.0f);
-    ~Bird();
+    Mesh *parts[PART_COUNT];
 
-    void update(float deltaTime);
-    void draw(); // Returns transforms for body and wings
-    
-    glm::vec3 getPosition() const { return position; }
-    glm::mat4 getBodyTransform() const;
-    glm::mat4 getHeadTransform() const;
-    glm::mat4 getBeakTransform() const;
-    glm::mat4 getTailTransform() const;
-    glm::mat4 getLeftWingTransform() const;
-    glm::mat4 getRightWingTransform() const;
+    Bird();
+    ~Bird();
 
-private:
-    glm::vec3 position;
-    glm::vec3 center;        // Center of circular path
-    float radius;            // Circle radius
-    float flightAngle;       // Current angle in circle (radians)
-    float flightSpeed;       // Angular velocity
-    float wingFlapTime;      // For wing animation
-    float wingFlapSpeed;     // Wing flap frequency
-    
-    // New properties for landing behavior
-    State state;
-    float height;            // Current height from ground
-    float baseHeight;        // Cruising altitude
-    float groundTime;        // Time spent on ground
-    float maxGroundTime;     // How long to stay on ground
-    float flightTime;        // Time spent flying
-    float nextLandingTime;   // When to land next
+    /**
+     * Part layout relative to the body transform:
+     * translate(partOffset) * rotateZ(partFlapSign * flap) * rotateX(partTilt)
+     */
+    static glm::vec3 partOffset(int part);
+    static float partFlapSign(int part);    // +1 left wing, -1 right wing, 0 otherwise
+    static float partTiltDegrees(int part);
 };
 
 #endif
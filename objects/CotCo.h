@@ -7,22 +7,32 @@
 /**
  * Cột cờ (Flag Pole) với lá cờ Việt Nam
  * V2.0-Beta: With animation support
+ * V3.0: Flag is a tessellated grid waved on the GPU (shaders/flag.vs)
  */
 class CotCo
 {
 public:
     Mesh *pole;     // Cylinder pole
-    Mesh *flag;     // Plane for flag
+    Mesh *flag;     // Tessellated grid for flag (displaced in flag.vs)
     Mesh *base;     // Base platform
     glm::vec3 position;
 
+    // Flag cloth dimensions (3:2 ratio) and grid resolution
+    static constexpr float FLAG_WIDTH = 3.0f;
+    static constexpr float FLAG_HEIGHT = 2.0f;
+    static constexpr float POLE_HEIGHT = 25.0f;
+
     CotCo(glm::vec3 pos);
     ~CotCo();
 
     // V2.0-Beta: Animation
     void update(float deltaTime);
     glm::vec3 getFlagPosition(); // For flag at current height
-    glm::mat4 getFlagTransform(); // With wave animation
+
+    // GPU flag: static model matrix + per-frame uniforms for flag.vs
+    glm::mat4 getFlagModel() const;                             // Anchored at pole base
+    float getWaveTime() const { return waveTime; }              // "waveTime" uniform
+    float getFlagRaise() const { return flagHeight * POLE_HEIGHT; } // "flagRaise" uniform
     
     void raiseFlag();  // Start raising animation
     void lowerFlag();  // Start lowering animation
@@ -1,5 +1,6 @@
 #include "Fence.h"
 #include "Primitives.h"
+#include "ShadowCasters.h"
 
 Fence::Fence(glm::vec3 start, glm::vec3 end, float h)
     : startPos(start), endPos(end), height(h)
@@ -71,7 +72,7 @@ void Fence::createSquarePatterns()
     }
 }
 
-void Fence::draw(Shader &shader)
+void Fence::forEachPart(const std::function<void(Mesh *, const glm::mat4 &)> &visit) const
 {
     glm::vec3 direction = glm::normalize(endPos - startPos);
     float length = glm::length(endPos - startPos);
@@ -91,15 +92,13 @@ void Fence::draw(Shader &shader)
     glm::mat4 model = glm::mat4(1.0f);
     model = glm::translate(model, center + glm::vec3(0.0f, height, 0.0f));
     model = glm::rotate(model, angle, glm::vec3(0.0f, 1.0f, 0.0f));
-    shader.setMat4("model", model);
-    segments[0]->draw();
+    visit(segments[0], model);
     
     // Bottom bar (index 1)
     model = glm::mat4(1.0f);
     model = glm::translate(model, center + glm::vec3(0.0f, 0.1f, 0.0f));
     model = glm::rotate(model, angle, glm::vec3(0.0f, 1.0f, 0.0f));
-    shader.setMat4("model", model);
-    segments[1]->draw();
+    visit(segments[1], model);
     
     // Posts (index 2 onwards)
     int numPosts = segments.size() - 2;
@@ -111,8 +110,7 @@ void Fence::draw(Shader &shader)
         model = glm::mat4(1.0f);
         model = glm::translate(model, pos + glm::vec3(0.0f, height * 0.5f, 0.0f));
         model = glm::rotate(model, angle, glm::vec3(0.0f, 1.0f, 0.0f));
-        shader.setMat4("model", model);
-        segments[2 + i]->draw();
+        visit(segments[2 + i], model);
     }
     
     // Draw patterns
@@ -131,61 +129,67 @@ void Fence::draw(Shader &shader)
         model = glm::mat4(1.0f);
         model = glm::translate(model, pos + glm::vec3(0.0f, height - 0.15f * scale, 0.0f));
         model = glm::rotate(model, angle, glm::vec3(0.0f, 1.0f, 0.0f));
-        shader.setMat4("model", model);
-        patterns[i*8 + 0]->draw();
+        visit(patterns[i*8 + 0], model);
         
         // 2. Outer Square Bottom
         model = glm::mat4(1.0f);
         model = glm::translate(model, pos + glm::vec3(0.0f, 0.1f + 0.15f * scale, 0.0f)); // slightly above bottom bar
         model = glm::rotate(model, angle, glm::vec3(0.0f, 1.0f, 0.0f));
-        shader.setMat4("model", model);
-        patterns[i*8 + 1]->draw();
+        visit(patterns[i*8 + 1], model);
         
         // 3. Outer Square Left
         model = glm::mat4(1.0f);
         model = glm::translate(model, pos + glm::vec3(0.0f, height * 0.5f, 0.0f));
         model = glm::rotate(model, angle, glm::vec3(0.0f, 1.0f, 0.0f));
         model = glm::translate(model, glm::vec3(-0.75f * scale, 0.0f, 0.0f));
-        shader.setMat4("model", model);
-        patterns[i*8 + 2]->draw();
+        visit(patterns[i*8 + 2], model);
         
         // 4. Outer Square Right
         model = glm::mat4(1.0f);
         model = glm::translate(model, pos + glm::vec3(0.0f, height * 0.5f, 0.0f));
         model = glm::rotate(model, angle, glm::vec3(0.0f, 1.0f, 0.0f));
         model = glm::translate(model, glm::vec3(0.75f * scale, 0.0f, 0.0f));
-        shader.setMat4("model", model);
-        patterns[i*8 + 3]->draw();
+        visit(patterns[i*8 + 3], model);
         
         // Inner Square (Similar logic but smaller)
         // 5. Inner Top
         model = glm::mat4(1.0f);
         model = glm::translate(model, pos + glm::vec3(0.0f, height - 0.3f * scale, 0.0f));
         model = glm::rotate(model, angle, glm::vec3(0.0f, 1.0f, 0.0f));
-        shader.setMat4("model", model);
-        patterns[i*8 + 4]->draw();
+        visit(patterns[i*8 + 4], model);
         
         // 6. Inner Bottom
         model = glm::mat4(1.0f);
         model = glm::translate(model, pos + glm::vec3(0.0f, 0.1f + 0.3f * scale, 0.0f));
         model = glm::rotate(model, angle, glm::vec3(0.0f, 1.0f, 0.0f));
-        shader.setMat4("model", model);
-        patterns[i*8 + 5]->draw();
+        visit(patterns[i*8 + 5], model);
         
         // 7. Inner Left
         model = glm::mat4(1.0f);
         model = glm::translate(model, pos + glm::vec3(0.0f, height * 0.5f, 0.0f));
         model = glm::rotate(model, angle, glm::vec3(0.0f, 1.0f, 0.0f));
         model = glm::translate(model, glm::vec3(-0.4f * scale, 0.0f, 0.0f));
-        shader.setMat4("model", model);
-        patterns[i*8 + 6]->draw();
+        visit(patterns[i*8 + 6], model);
         
         // 8. Inner Right
         model = glm::mat4(1.0f);
         model = glm::translate(model, pos + glm::vec3(0.0f, height * 0.5f, 0.0f));
         model = glm::rotate(model, angle, glm::vec3(0.0f, 1.0f, 0.0f));
         model = glm::translate(model, glm::vec3(0.4f * scale, 0.0f, 0.0f));
-        shader.setMat4("model", model);
-        patterns[i*8 + 7]->draw();
+        visit(patterns[i*8 + 7], model);
     }
 }
+
+void Fence::draw(Shader &shader)
+{
+    forEachPart([&](Mesh *mesh, const glm::mat4 &model)
+                {
+                    shader.setMat4("model", model);
+                    mesh->draw(); });
+}
+
+void Fence::appendShadowCasters(ShadowCasters &casters) const
+{
+    forEachPart([&](Mesh *mesh, const glm::mat4 &model)
+                { casters.add(mesh, model); });
+}
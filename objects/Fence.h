@@ -4,8 +4,11 @@
 #include "Mesh.h"
 #include "../Shader.h"
 #include <glm/glm.hpp>
+#include <functional>
 #include <vector>
 
+class ShadowCasters;
+
 /**
  * Decorative fence with traditional square patterns
  * Like the real fence at Ba Dinh Square
@@ -27,6 +30,11 @@ public:
     void createSquarePatterns();
     
     void draw(Shader &shader);
+    void appendShadowCasters(ShadowCasters &casters) const;
+
+private:
+    // Every bar, post and pattern piece with its model matrix
+    void forEachPart(const std::function<void(Mesh *, const glm::mat4 &)> &visit) const;
 };
 
 #endif
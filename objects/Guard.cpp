@@ -1,12 +1,10 @@
 #include "Guard.h"
 #include "../models/Primitives.h"
-#include "../models/Texture.h"
 #include "../Shader.h"
 #include <glm/gtc/matrix_transform.hpp>
 #include <cmath>
 
-Guard::Guard(glm::vec3 pos, float rotY)
-    : position(pos), rotationY(rotY), time(0.0f)
+Guard::Guard()
 {
     initModel();
 }
@@ -48,6 +46,7 @@ void Guard::initModel()
     // Pith Helmet (Vietnamese ceremonial style)
     hat = Primitives::createSphere(0.15f, 20, 20); // Rounded helmet
     helmetVisor = Primitives::createBox(0.18f, 0.02f, 0.12f); // Visor
+    helmetVisor->castsShadow = false; // Thinner than a shadow texel
     
     // Rifle: Long thin box (AK-47 style)
     rifle = Primitives::createBox(0.05f, 1.2f, 0.1f);
@@ -61,14 +60,7 @@ void Guard::initModel()
     bootRight = Primitives::createBox(0.2f, 0.25f, 0.28f);
 }
 
-void Guard::update(float deltaTime)
-{
-    // Standing at attention - no movement
-    // Only subtle breathing animation
-    time += deltaTime;
-}
-
-void Guard::draw(Shader &shader, Texture* uniformTex, Texture* metalTex, Texture* faceTex)
+void Guard::writePartTransforms(glm::vec3 position, float rotationY, float time, glm::mat4 *out)
 {
     glm::mat4 model = glm::mat4(1.0f);
     model = glm::translate(model, position);
@@ -77,83 +69,88 @@ void Guard::draw(Shader &shader, Texture* uniformTex, Texture* metalTex, Texture
     // Breathing animation (scale Y slightly)
     float breath = 1.0f + sin(time * 2.0f) * 0.005f;
     
-    // === BOOTS (Black leather) ===
-    if (metalTex) metalTex->bind(0); // Using metalTex for black boots
+    // Boots and legs
+    out[BOOT_LEFT] = glm::translate(model, glm::vec3(-0.15f, 0.125f, 0.0f));
+    out[BOOT_RIGHT] = glm::translate(model, glm::vec3(0.15f, 0.125f, 0.0f));
+    out[LEG_LEFT] = glm::translate(model, glm::vec3(-0.15f, 0.7f, 0.0f));
+    out[LEG_RIGHT] = glm::translate(model, glm::vec3(0.15f, 0.7f, 0.0f));
     
-    // Left Boot
-    glm::mat4 modelBootL = glm::translate(model, glm::vec3(-0.15f, 0.125f, 0.0f));
-    shader.setMat4("model", modelBootL);
-    bootLeft->draw();
+    // Torso
+    out[BODY] = glm::scale(glm::translate(model, glm::vec3(0.0f, 1.15f + 0.35f, 0.0f)), glm::vec3(1.0f, breath, 1.0f));
+    out[COLLAR] = glm::translate(model, glm::vec3(0.0f, 1.54f, 0.0f));
+    out[BELT] = glm::translate(model, glm::vec3(0.0f, 1.15f, 0.0f));
     
-    // Right Boot
-    glm::mat4 modelBootR = glm::translate(model, glm::vec3(0.15f, 0.125f, 0.0f));
-    shader.setMat4("model", modelBootR);
-    bootRight->draw();
+    // Arms - standing at attention
+    out[ARM_LEFT] = glm::translate(model, glm::vec3(-0.32f, 1.15f, 0.0f));
+    out[ARM_RIGHT] = glm::translate(model, glm::vec3(0.32f, 1.15f, 0.0f));
     
-    // === LEGS (White pants) ===
-    if (uniformTex) uniformTex->bind(0);
+    // Head and helmet rise with the chest
+    out[HEAD] = glm::translate(model, glm::vec3(0.0f, 1.68f + (breath - 1.0f), 0.0f));
+    out[HAT] = glm::translate(model, glm::vec3(0.0f, 1.85f + (breath - 1.0f), 0.0f));
+    out[VISOR] = glm::translate(model, glm::vec3(0.0f, 1.78f + (breath - 1.0f), 0.14f));
     
-    // Left Leg
-    glm::mat4 modelLegL = glm::translate(model, glm::vec3(-0.15f, 0.7f, 0.0f));
-    shader.setMat4("model", modelLegL);
-    legLeft->draw();
+    // Rifle held at side with a slight angle
+    out[RIFLE] = glm::rotate(glm::translate(model, glm::vec3(-0.38f, 0.9f, 0.0f)), glm::radians(5.0f), glm::vec3(0, 0, 1));
+}
+
+void Guard::draw(Shader &shader, int uniformLayer, int metalLayer, int faceLayer, const glm::mat4 *partTransforms)
+{
+    // === BOOTS (Black leather) ===
+    shader.setInt("materialLayer", metalLayer); // Black boots
+    shader.setMat4("model", partTransforms[BOOT_LEFT]);
+    bootLeft->draw();
+    shader.setMat4("model", partTransforms[BOOT_RIGHT]);
+    bootRight->draw();
     
-    // Right Leg
-    glm::mat4 modelLegR = glm::translate(model, glm::vec3(0.15f, 0.7f, 0.0f));
-    shader.setMat4("model", modelLegR);
+    // === LEGS, BODY, COLLAR (White uniform) ===
+    shader.setInt("materialLayer", uniformLayer);
+    shader.setMat4("model", partTransforms[LEG_LEFT]);
+    legLeft->draw();
+    shader.setMat4("model", partTransforms[LEG_RIGHT]);
     legRight->draw();
-    
-    // === BODY (White uniform) ===
-    glm::mat4 modelBody = glm::translate(model, glm::vec3(0.0f, 1.15f + 0.35f, 0.0f));
-    modelBody = glm::scale(modelBody, glm::vec3(1.0f, breath, 1.0f));
-    shader.setMat4("model", modelBody);
+    shader.setMat4("model", partTransforms[BODY]);
     body->draw();
-    
-    // === COLLAR (White) ===
-    glm::mat4 modelCollar = glm::translate(model, glm::vec3(0.0f, 1.54f, 0.0f));
-    shader.setMat4("model", modelCollar);
+    shader.setMat4("model", partTransforms[COLLAR]);
     collar->draw();
     
     // === BELT (Black/Metal) ===
-    if (metalTex) metalTex->bind(0);
-    glm::mat4 modelBelt = glm::translate(model, glm::vec3(0.0f, 1.15f, 0.0f));
-    shader.setMat4("model", modelBelt);
+    shader.setInt("materialLayer", metalLayer);
+    shader.setMat4("model", partTransforms[BELT]);
     belt->draw();
     
-    // === ARMS (White uniform) - Standing at attention ===
-    if (uniformTex) uniformTex->bind(0);
-    
-    // Left Arm - straight down, holding rifle
-    glm::mat4 modelArmL = glm::translate(model, glm::vec3(-0.32f, 1.15f, 0.0f));
-    shader.setMat4("model", modelArmL);
+    // === ARMS (White uniform) ===
+    shader.setInt("materialLayer", uniformLayer);
+    shader.setMat4("model", partTransforms[ARM_LEFT]);
     armLeft->draw();
-    
-    // Right Arm - straight down at side
-    glm::mat4 modelArmR = glm::translate(model, glm::vec3(0.32f, 1.15f, 0.0f));
-    shader.setMat4("model", modelArmR);
+    shader.setMat4("model", partTransforms[ARM_RIGHT]);
     armRight->draw();
 
     // === HEAD (Skin tone) ===
-    if (faceTex) faceTex->bind(0);
-    glm::mat4 modelHead = glm::translate(model, glm::vec3(0.0f, 1.68f + (breath - 1.0f), 0.0f));
-    shader.setMat4("model", modelHead);
+    shader.setInt("materialLayer", faceLayer);
+    shader.setMat4("model", partTransforms[HEAD]);
     head->draw();
     
-    // === HELMET (Golden yellow pith helmet) ===
-    if (metalTex) metalTex->bind(0); // Will use golden texture
-    glm::mat4 modelHat = glm::translate(model, glm::vec3(0.0f, 1.85f + (breath - 1.0f), 0.0f));
-    shader.setMat4("model", modelHat);
+    // === HELMET, VISOR, RIFLE (Metal) ===
+    shader.setInt("materialLayer", metalLayer);
+    shader.setMat4("model", partTransforms[HAT]);
     hat->draw();
-    
-    // Helmet Visor
-    glm::mat4 modelVisor = glm::translate(model, glm::vec3(0.0f, 1.78f + (breath - 1.0f), 0.14f));
-    shader.setMat4("model", modelVisor);
+    shader.setMat4("model", partTransforms[VISOR]);
     helmetVisor->draw();
-    
-    // === RIFLE (Metal) - Held at side ===
-    glm::mat4 modelRifle = glm::translate(model, glm::vec3(-0.38f, 0.9f, 0.0f));
-    modelRifle = glm::rotate(modelRifle, glm::radians(5.0f), glm::vec3(0, 0, 1)); // Slight angle
-    shader.setMat4("model", modelRifle);
+    shader.setMat4("model", partTransforms[RIFLE]);
     rifle->draw();
+
+    shader.setInt("materialLayer", -1);
 }
 
+void Guard::drawShadowCasters(Shader &shader, const glm::mat4 *partTransforms)
+{
+    Mesh *parts[PART_COUNT] = {bootLeft, bootRight, legLeft, legRight, body, collar, belt,
+                               armLeft, armRight, head, hat, helmetVisor, rifle};
+    for (int i = 0; i < PART_COUNT; i++)
+    {
+        if (!parts[i]->castsShadow)
+            continue;
+        shader.setMat4("model", partTransforms[i]);
+        parts[i]->draw();
+    }
+}
@@ -4,15 +4,34 @@
 #include <vector>
 #include "Mesh.h"
 
-class Texture;
 class Shader;
 
+/**
+ * Honour guard model (standing at attention)
+ * Meshes are shared by every guard; position, orientation and breathing
+ * time live in AnimationSystem, which writes PART_COUNT matrices per guard.
+ */
 class Guard
 {
 public:
-    glm::vec3 position;
-    float rotationY; // Orientation in degrees
-    
+    // Part order used by the transform buffer (also the draw order)
+    enum Part {
+        BOOT_LEFT,
+        BOOT_RIGHT,
+        LEG_LEFT,
+        LEG_RIGHT,
+        BODY,
+        COLLAR,
+        BELT,
+        ARM_LEFT,
+        ARM_RIGHT,
+        HEAD,
+        HAT,
+        VISOR,
+        RIFLE,
+        PART_COUNT
+    };
+
     // Body parts
     Mesh* head;
     Mesh* body;
@@ -30,14 +49,25 @@ public:
     Mesh* bootRight;   // Right boot
     Mesh* helmetVisor; // Helmet visor detail
 
-    // Animation state
-    float time;
-
-    Guard(glm::vec3 pos, float rotY = 0.0f);
+    Guard();
     ~Guard();
 
-    void draw(Shader &shader, Texture* uniformTex, Texture* metalTex, Texture* faceTex);
-    void update(float deltaTime);
+    // Draw one guard from its PART_COUNT part matrices
+    // Materials are layers of the bound TextureArray (materialLayer uniform),
+    // so all parts draw without a texture bind
+    void draw(Shader &shader, int uniformLayer, int metalLayer, int faceLayer, const glm::mat4 *partTransforms);
+
+    // Depth only: parts with castsShadow, no textures
+    void drawShadowCasters(Shader &shader, const glm::mat4 *partTransforms);
+
+    /**
+     * Write the model matrix of every part
+     * @param position Feet position
+     * @param rotationY Orientation in degrees
+     * @param time Breathing animation time
+     * @param out PART_COUNT matrices
+     */
+    static void writePartTransforms(glm::vec3 position, float rotationY, float time, glm::mat4 *out);
 
 private:
     void initModel();
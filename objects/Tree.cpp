@@ -1,5 +1,7 @@
 #include "Tree.h"
 #include "Primitives.h"
+#include "RenderQueue.h"
+#include "ShadowCasters.h"
 #include <cmath>
 #include <glm/gtx/vector_angle.hpp>
 
@@ -131,6 +133,33 @@ void Tree::draw(Shader &shader, Texture *barkTex, Texture *leafTex)
     }
 }
 
+void Tree::appendDrawItems(RenderQueue &queue, Texture *barkTex, Texture *leafTex, bool withBranches,
+                           int occlusionId) const
+{
+    glm::mat4 base = glm::translate(glm::mat4(1.0f), position);
+
+    queue.push({trunk, barkTex, glm::translate(base, glm::vec3(0.0f, 1.5f * scale, 0.0f)), false, occlusionId});
+
+    // Far away the branches are hidden by the foliage anyway
+    if (withBranches)
+    {
+        for (size_t i = 0; i < branches.size(); i++)
+            queue.push({branches[i], barkTex, base * branchTransforms[i], false, occlusionId});
+    }
+
+    for (size_t i = 0; i < foliageParts.size(); i++)
+        queue.push({foliageParts[i], leafTex, base * foliageTransforms[i], false, occlusionId});
+}
+
+void Tree::appendShadowCasters(ShadowCasters &casters) const
+{
+    glm::mat4 base = glm::translate(glm::mat4(1.0f), position);
+
+    casters.add(trunk, glm::translate(base, glm::vec3(0.0f, 1.5f * scale, 0.0f)));
+    for (size_t i = 0; i < foliageParts.size(); i++)
+        casters.add(foliageParts[i], base * foliageTransforms[i]);
+}
+
 glm::mat4 Tree::getTrunkTransform() const
 {
     return glm::mat4(1.0f); // Deprecated
@@ -9,6 +9,9 @@
 #include "../Shader.h"
 #include "../models/Texture.h"
 
+class RenderQueue;
+class ShadowCasters;
+
 /**
  * Realistic tree model with trunk and spreading foliage
  * For decorative landscaping around Lang Bac
@@ -31,6 +34,18 @@ public:
     
     void createBranch(glm::vec3 startPos, glm::vec3 direction, float length, float radius, int depth);
     void draw(Shader &shader, Texture *barkTex, Texture *leafTex);
+
+    // Queue trunk, foliage and (for the detailed LOD) branches; callable from jobs.
+    // occlusionId tags every item (see OcclusionQueries), -1 for none
+    void appendDrawItems(RenderQueue &queue, Texture *barkTex, Texture *leafTex, bool withBranches,
+                         int occlusionId = -1) const;
+
+    // Trunk and foliage; the branches are hidden inside the foliage from the sun
+    void appendShadowCasters(ShadowCasters &casters) const;
+
+    // Bounding sphere around trunk, branches and foliage (world space)
+    glm::vec3 getBoundsCenter() const { return position + glm::vec3(0.0f, 5.0f * scale, 0.0f); }
+    float getBoundsRadius() const { return 7.0f * scale; }
     
     // Deprecated but kept for compatibility if needed (though draw() is preferred)
     glm::mat4 getTrunkTransform() const;
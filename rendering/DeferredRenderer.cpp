@@ -0,0 +1,167 @@
+#include "DeferredRenderer.h"
+#include "../Shader.h"
+#include "../models/Mesh.h"
+#include "../models/Primitives.h"
+#include <iostream>
+
+namespace
+{
+    const int VOLUME_SECTORS = 16;
+    const int VOLUME_STACKS = 12;
+    // Flat faces of the tessellated sphere sit inside the unit radius
+    const float VOLUME_SCALE = 1.05f;
+    const int VEC4_PER_LIGHT = 4;
+
+    // internal format, format, type per target
+    const GLenum TARGET_FORMATS[4][3] = {
+        {GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE},                        // Albedo
+        {GL_RGBA16F, GL_RGBA, GL_FLOAT},                              // Normal + shininess
+        {GL_RGBA16F, GL_RGBA, GL_FLOAT},                              // Emissive (bulbs exceed 1)
+        {GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8}}; // Window's depth layout, so it can be blitted
+}
+
+DeferredRenderer::DeferredRenderer(int w, int h)
+    : width(w), height(h)
+{
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glGenTextures(TARGET_COUNT, textures);
+    for (int i = 0; i < TARGET_COUNT; i++)
+    {
+        glBindTexture(GL_TEXTURE_2D, textures[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, TARGET_FORMATS[i][0], width, height, 0, TARGET_FORMATS[i][1], TARGET_FORMATS[i][2], NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        GLenum attachment = i == DEPTH ? GL_DEPTH_STENCIL_ATTACHMENT : GL_COLOR_ATTACHMENT0 + i;
+        glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, textures[i], 0);
+    }
+
+    const GLenum drawBuffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2};
+    glDrawBuffers(3, drawBuffers);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::FRAMEBUFFER:: G-buffer is not complete!" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenVertexArrays(1, &emptyVAO);
+
+    lightVolume = Primitives::createSphere(1.0f, VOLUME_SECTORS, VOLUME_STACKS);
+    glGenBuffers(1, &lightVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, lightVBO);
+    glBufferData(GL_ARRAY_BUFFER, VEC4_PER_LIGHT * sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
+    lightVolume->setInstanceAttributes(lightVBO, 3, VEC4_PER_LIGHT, VEC4_PER_LIGHT * sizeof(glm::vec4));
+}
+
+DeferredRenderer::~DeferredRenderer()
+{
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteTextures(TARGET_COUNT, textures);
+    glDeleteVertexArrays(1, &emptyVAO);
+    glDeleteBuffers(1, &lightVBO);
+    delete lightVolume;
+}
+
+void DeferredRenderer::resize(int w, int h)
+{
+    if (w == width && h == height)
+        return;
+    width = w;
+    height = h;
+
+    // Same texture names, so the framebuffer attachments stay valid
+    for (int i = 0; i < TARGET_COUNT; i++)
+    {
+        glBindTexture(GL_TEXTURE_2D, textures[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, TARGET_FORMATS[i][0], width, height, 0, TARGET_FORMATS[i][1], TARGET_FORMATS[i][2], NULL);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void DeferredRenderer::beginGeometryPass()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, width, height);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glDisable(GL_BLEND); // Alpha would blend normals and emission too
+}
+
+void DeferredRenderer::endGeometryPass()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glEnable(GL_BLEND);
+}
+
+void DeferredRenderer::bindGBuffer(Shader &shader, int firstUnit, const glm::mat4 &viewProjection) const
+{
+    const char *names[TARGET_COUNT] = {"gbufferAlbedo", "gbufferNormal", "gbufferEmissive", "gbufferDepth"};
+
+    shader.use();
+    for (int i = 0; i < TARGET_COUNT; i++)
+    {
+        glActiveTexture(GL_TEXTURE0 + firstUnit + i);
+        glBindTexture(GL_TEXTURE_2D, textures[i]);
+        shader.setInt(names[i], firstUnit + i);
+    }
+    glActiveTexture(GL_TEXTURE0);
+
+    shader.setMat4("inverseViewProjection", glm::inverse(viewProjection));
+}
+
+void DeferredRenderer::drawFullscreen() const
+{
+    glDisable(GL_DEPTH_TEST);
+    glDepthMask(GL_FALSE);
+
+    glBindVertexArray(emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    glDepthMask(GL_TRUE);
+    glEnable(GL_DEPTH_TEST);
+}
+
+void DeferredRenderer::drawPointLights(Shader &pointShader, const LightClusters::Grid &grid)
+{
+    GLsizei lightCount = static_cast<GLsizei>(grid.lights.size() / VEC4_PER_LIGHT);
+    if (lightCount == 0)
+        return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, lightVBO);
+    glBufferData(GL_ARRAY_BUFFER, grid.lights.size() * sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, grid.lights.size() * sizeof(glm::vec4), grid.lights.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    pointShader.use();
+    pointShader.setFloat("volumeScale", VOLUME_SCALE);
+    pointShader.setVec2("viewportSize", glm::vec2((float)width, (float)height));
+
+    // Back faces only, no depth test: each covered pixel is lit exactly once,
+    // also when the camera is inside the volume
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+    glDisable(GL_DEPTH_TEST);
+    glDepthMask(GL_FALSE);
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_FRONT);
+
+    lightVolume->drawInstanced(lightCount);
+
+    glCullFace(GL_BACK);
+    glDisable(GL_CULL_FACE);
+    glDepthMask(GL_TRUE);
+    glEnable(GL_DEPTH_TEST);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void DeferredRenderer::copyDepthTo(GLuint framebuffer) const
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+}
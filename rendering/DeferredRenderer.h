@@ -0,0 +1,67 @@
+#ifndef DEFERREDRENDERER_H
+#define DEFERREDRENDERER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "../core/LightClusters.h"
+
+class Mesh;
+class Shader;
+
+/**
+ * Deferred shading path - G-buffer plus screen-space light passes
+ * The geometry pass draws the scene with gbuffer.fs programs into albedo,
+ * normal/shininess and emissive targets sharing one depth texture. The sun
+ * (with shadow) and emission are then applied by a fullscreen pass, and each
+ * street light by an instanced sphere volume that only shades the pixels it
+ * covers. Depth is copied back so forward passes (clouds) still depth-test.
+ */
+class DeferredRenderer
+{
+public:
+    DeferredRenderer(int width, int height);
+    ~DeferredRenderer();
+
+    // Reallocate the targets (no-op when the size is unchanged)
+    void resize(int width, int height);
+
+    // Bind and clear the G-buffer; blending is off until endGeometryPass()
+    void beginGeometryPass();
+    void endGeometryPass();
+
+    // G-buffer samplers on firstUnit..firstUnit+3 and the depth unprojection
+    void bindGBuffer(Shader &shader, int firstUnit, const glm::mat4 &viewProjection) const;
+
+    // Fullscreen triangle (deferred_light.vs); no depth test or writes
+    void drawFullscreen() const;
+
+    // Additive light volumes for the binned lights (deferred_point.vs/fs);
+    // pointShader must already have its G-buffer bound
+    void drawPointLights(Shader &pointShader, const LightClusters::Grid &grid);
+
+    // Copy G-buffer depth into another framebuffer (0 = default)
+    void copyDepthTo(GLuint framebuffer) const;
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+private:
+    enum Target
+    {
+        ALBEDO,
+        NORMAL,
+        EMISSIVE,
+        DEPTH,
+        TARGET_COUNT
+    };
+
+    int width, height;
+    GLuint fbo;
+    GLuint textures[TARGET_COUNT];
+    GLuint emptyVAO; // Core profile needs a VAO even without attributes
+
+    Mesh *lightVolume; // Unit sphere
+    GLuint lightVBO;   // 4 vec4 per light, as in LightClusters::Grid
+};
+
+#endif
@@ -0,0 +1,169 @@
+#include "DynamicResolution.h"
+#include "../Shader.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+    const float MIN_SCALE = 0.5f;
+    const float MAX_SCALE = 1.0f;
+    const float SCALE_STEP = 0.05f;     // Scales are multiples of this, so small noise changes nothing
+    const float MAX_SCALE_RAISE = 0.1f; // Grow slowly, shrink as far as needed
+    const int ADJUST_FRAMES = 30;       // Let the average settle between changes
+    const double SMOOTHING = 0.1;       // Weight of the newest frame in the average
+    const double RAISE_BELOW = 0.8;     // Only grow when this far under budget
+    const float SHARPNESS = 0.6f;
+}
+
+DynamicResolution::DynamicResolution(int outW, int outH, float budget, bool adapt)
+    : outputWidth(std::max(1, outW)), outputHeight(std::max(1, outH)), renderWidth(0), renderHeight(0),
+      budgetMs(budget), adaptive(adapt), scale(MAX_SCALE), current(0), smoothedMs(-1.0), framesSinceChange(0)
+{
+    glGenFramebuffers(1, &fbo);
+    glGenTextures(1, &colorTexture);
+    glGenRenderbuffers(1, &depthBuffer);
+    glGenVertexArrays(1, &emptyVAO);
+    glGenQueries(QUERY_COUNT, queries);
+    std::fill(issued, issued + QUERY_COUNT, false);
+
+    resizeTarget();
+}
+
+DynamicResolution::~DynamicResolution()
+{
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteTextures(1, &colorTexture);
+    glDeleteRenderbuffers(1, &depthBuffer);
+    glDeleteVertexArrays(1, &emptyVAO);
+    glDeleteQueries(QUERY_COUNT, queries);
+}
+
+void DynamicResolution::resizeTarget()
+{
+    int width = std::max(1, (int)std::lround(outputWidth * scale));
+    int height = std::max(1, (int)std::lround(outputHeight * scale));
+    if (width == renderWidth && height == renderHeight)
+        return;
+    renderWidth = width;
+    renderHeight = height;
+
+    glBindTexture(GL_TEXTURE_2D, colorTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, renderWidth, renderHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // Window's depth layout, so G-buffer and cloud depth can be blitted in and out
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, renderWidth, renderHeight);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::FRAMEBUFFER:: Scene target is not complete!" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void DynamicResolution::beginFrame(int outW, int outH)
+{
+    // A minimised window reports 0x0; keep rendering at the last size
+    if (outW > 0 && outH > 0)
+    {
+        outputWidth = outW;
+        outputHeight = outH;
+    }
+    resizeTarget();
+
+    if (adaptive)
+        glBeginQuery(GL_TIME_ELAPSED, queries[current]);
+}
+
+void DynamicResolution::endFrame()
+{
+    if (!adaptive)
+        return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    issued[current] = true;
+    current = (current + 1) % QUERY_COUNT;
+
+    // The oldest query is reused next frame; take its result if the GPU is done
+    if (!issued[current])
+        return;
+    GLuint available = GL_FALSE;
+    glGetQueryObjectuiv(queries[current], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available)
+    {
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(queries[current], GL_QUERY_RESULT, &nanoseconds);
+        adjustScale(nanoseconds / 1.0e6);
+    }
+    issued[current] = false;
+}
+
+void DynamicResolution::adjustScale(double gpuMs)
+{
+    smoothedMs = smoothedMs < 0.0 ? gpuMs : smoothedMs + (gpuMs - smoothedMs) * SMOOTHING;
+    if (++framesSinceChange < ADJUST_FRAMES)
+        return;
+
+    // Pixel count goes with scale^2, so time scales the same way
+    float target = scale;
+    if (smoothedMs > budgetMs)
+        target = scale * (float)std::sqrt(budgetMs / smoothedMs);
+    else if (smoothedMs < budgetMs * RAISE_BELOW)
+        target = std::min(scale * (float)std::sqrt(budgetMs * RAISE_BELOW / smoothedMs), scale + MAX_SCALE_RAISE);
+
+    // Round down when shrinking so one step is enough to get under budget
+    float steps = target < scale ? std::floor(target / SCALE_STEP) : std::round(target / SCALE_STEP);
+    target = std::min(MAX_SCALE, std::max(MIN_SCALE, steps * SCALE_STEP));
+    if (std::fabs(target - scale) < SCALE_STEP * 0.5f)
+        return;
+
+    std::cout << "Render scale " << scale << " -> " << target << " (GPU " << smoothedMs << " ms, budget "
+              << budgetMs << " ms)" << std::endl;
+    scale = target;
+    framesSinceChange = 0;
+}
+
+void DynamicResolution::bindTarget() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, renderWidth, renderHeight);
+}
+
+void DynamicResolution::present(Shader &upscaleShader, int textureUnit) const
+{
+    if (renderWidth == outputWidth && renderHeight == outputHeight)
+    {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glBlitFramebuffer(0, 0, renderWidth, renderHeight, 0, 0, outputWidth, outputHeight,
+                          GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, outputWidth, outputHeight);
+
+    upscaleShader.use();
+    glActiveTexture(GL_TEXTURE0 + textureUnit);
+    glBindTexture(GL_TEXTURE_2D, colorTexture);
+    glActiveTexture(GL_TEXTURE0);
+    upscaleShader.setInt("sceneColor", textureUnit);
+    upscaleShader.setVec2("sourceSize", glm::vec2((float)renderWidth, (float)renderHeight));
+    upscaleShader.setFloat("sharpness", SHARPNESS);
+
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    glBindVertexArray(emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glEnable(GL_DEPTH_TEST);
+}
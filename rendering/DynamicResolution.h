@@ -0,0 +1,63 @@
+#ifndef DYNAMICRESOLUTION_H
+#define DYNAMICRESOLUTION_H
+
+#include <glad/glad.h>
+
+class Shader;
+
+/**
+ * Offscreen scene target whose size follows a GPU frame-time budget
+ * The scene renders into a colour + depth target at renderScale times the
+ * window's framebuffer size. Whole-frame GPU time comes from GL_TIME_ELAPSED
+ * queries read back a few frames late (never stalling); every few frames the
+ * scale moves towards the budget, assuming cost grows with the pixel count.
+ * present() upscales to the window with a contrast-adaptive sharpen, or
+ * blits when the sizes match. Render thread only.
+ */
+class DynamicResolution
+{
+public:
+    /**
+     * @param budgetMs GPU time per frame the controller aims for
+     * @param adaptive False keeps the scale at 1 and issues no timer queries
+     */
+    DynamicResolution(int outputWidth, int outputHeight, float budgetMs, bool adaptive);
+    ~DynamicResolution();
+
+    // Follow the window size, apply the latest scale and start the timer
+    void beginFrame(int outputWidth, int outputHeight);
+    // Stop the timer and adjust the scale from finished queries
+    void endFrame();
+
+    // Scene target with its viewport
+    void bindTarget() const;
+    GLuint getFramebuffer() const { return fbo; }
+    int getRenderWidth() const { return renderWidth; }
+    int getRenderHeight() const { return renderHeight; }
+
+    // Scene colour to the default framebuffer at the window size
+    void present(Shader &upscaleShader, int textureUnit) const;
+
+private:
+    static const int QUERY_COUNT = 4; // Frames a timer result may lag
+
+    void resizeTarget();
+    void adjustScale(double gpuMs);
+
+    int outputWidth, outputHeight;
+    int renderWidth, renderHeight;
+    float budgetMs;
+    bool adaptive;
+    float scale;
+
+    GLuint fbo, colorTexture, depthBuffer;
+    GLuint emptyVAO;
+
+    GLuint queries[QUERY_COUNT];
+    bool issued[QUERY_COUNT];
+    int current;
+    double smoothedMs; // < 0 until the first result
+    int framesSinceChange;
+};
+
+#endif
@@ -0,0 +1,118 @@
+#include "FramePacer.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace
+{
+    const GLuint64 FENCE_TIMEOUT_NS = 100000000; // Waits loop in 100 ms slices
+}
+
+FramePacer::FramePacer(int maxFrames, int report)
+    : maxFramesInFlight(std::min(maxFrames, RING)), reportFrames(report), oldest(0), count(0), gpuToCpu(0.0),
+      lastSwap(-1.0), frameTimeSum(0.0), latencySum(0.0), latencyMax(0.0), frames(0), latencies(0)
+{
+    glGenQueries(RING, queries);
+    std::fill(fences, fences + RING, (GLsync)0);
+    calibrate();
+}
+
+FramePacer::~FramePacer()
+{
+    for (int i = 0; i < RING; i++)
+        if (fences[i])
+            glDeleteSync(fences[i]);
+    glDeleteQueries(RING, queries);
+}
+
+double FramePacer::now()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void FramePacer::endFrame(double inputTime)
+{
+    double swapTime = now();
+    if (lastSwap >= 0.0)
+    {
+        frameTimeSum += swapTime - lastSwap;
+        frames++;
+    }
+    lastSwap = swapTime;
+
+    // Ring full: the oldest frame has to finish before it can be reused
+    if (count == RING)
+        retire(true);
+
+    int slot = (oldest + count) % RING;
+    glQueryCounter(queries[slot], GL_TIMESTAMP);
+    fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    inputTimes[slot] = inputTime;
+    count++;
+
+    while (maxFramesInFlight > 0 && count > maxFramesInFlight)
+        retire(true);
+    while (count > 0)
+    {
+        int before = count;
+        retire(false);
+        if (count == before)
+            break;
+    }
+
+    if (reportFrames > 0 && frames >= reportFrames)
+        report();
+}
+
+void FramePacer::retire(bool wait)
+{
+    GLsync fence = fences[oldest];
+    if (wait)
+    {
+        while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_NS) == GL_TIMEOUT_EXPIRED)
+            ;
+    }
+    else
+    {
+        GLenum result = glClientWaitSync(fence, 0, 0);
+        if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+            return;
+    }
+
+    // Fence signalled, so the timestamp before it is available
+    GLuint64 gpuTime = 0;
+    glGetQueryObjectui64v(queries[oldest], GL_QUERY_RESULT, &gpuTime);
+    double latency = gpuTime * 1e-9 + gpuToCpu - inputTimes[oldest];
+    latencySum += latency;
+    latencyMax = std::max(latencyMax, latency);
+    latencies++;
+
+    glDeleteSync(fence);
+    fences[oldest] = 0;
+    oldest = (oldest + 1) % RING;
+    count--;
+}
+
+void FramePacer::calibrate()
+{
+    // GL_TIMESTAMP read back directly is the GPU clock right now
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    gpuToCpu = now() - gpuNow * 1e-9;
+}
+
+void FramePacer::report()
+{
+    double frameMs = frameTimeSum / frames * 1000.0;
+    std::cout << "Frame pacing: " << frameMs << " ms/frame (" << 1000.0 / frameMs << " fps)";
+    if (latencies > 0)
+        std::cout << ", input to present " << latencySum / latencies * 1000.0 << " ms avg, " << latencyMax * 1000.0
+                  << " ms max";
+    if (maxFramesInFlight > 0)
+        std::cout << ", at most " << maxFramesInFlight << " frame(s) in flight";
+    std::cout << std::endl;
+
+    frameTimeSum = latencySum = latencyMax = 0.0;
+    frames = latencies = 0;
+    calibrate(); // The two clocks drift apart slowly
+}
@@ -0,0 +1,52 @@
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include <glad/glad.h>
+
+/**
+ * Frames in flight and input-to-present latency on the render thread
+ * endFrame() follows each SwapBuffers: it stamps the frame with a
+ * GL_TIMESTAMP query and a fence. With a cap it then waits on the fence of
+ * the oldest frame until no more than the cap are queued on the GPU. A
+ * frame's latency runs from its input sample to its timestamp (the GPU
+ * finished its commands, present included). Results are read without
+ * waiting once the fence has signalled; averages print every reportFrames.
+ */
+class FramePacer
+{
+public:
+    /**
+     * @param maxFramesInFlight 0 leaves queueing to the driver
+     * @param reportFrames Frames per printed report (0 = never)
+     */
+    FramePacer(int maxFramesInFlight, int reportFrames);
+    ~FramePacer();
+
+    // Steady clock in seconds, for the input sample times handed to endFrame
+    static double now();
+
+    void endFrame(double inputTime);
+
+private:
+    static const int RING = 8; // Frames tracked at once (also the cap without one)
+
+    void retire(bool wait);
+    void calibrate();
+    void report();
+
+    int maxFramesInFlight;
+    int reportFrames;
+
+    GLsync fences[RING];
+    GLuint queries[RING];
+    double inputTimes[RING];
+    int oldest, count;
+
+    double gpuToCpu;   // Add to GPU timestamp seconds to get now() seconds
+    double lastSwap;   // < 0 before the first frame
+    double frameTimeSum;
+    double latencySum, latencyMax;
+    int frames, latencies;
+};
+
+#endif
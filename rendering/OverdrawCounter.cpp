@@ -0,0 +1,43 @@
+#include "OverdrawCounter.h"
+
+OverdrawCounter::OverdrawCounter()
+    : current(0), lastSamples(0), hasResult(false)
+{
+    glGenQueries(2, queries);
+    issued[0] = issued[1] = false;
+}
+
+OverdrawCounter::~OverdrawCounter()
+{
+    glDeleteQueries(2, queries);
+}
+
+void OverdrawCounter::begin()
+{
+    glBeginQuery(GL_SAMPLES_PASSED, queries[current]);
+}
+
+void OverdrawCounter::end()
+{
+    glEndQuery(GL_SAMPLES_PASSED);
+    issued[current] = true;
+    current ^= 1;
+
+    // The other query was issued a frame ago; take it if the GPU is done
+    if (!issued[current])
+        return;
+    GLuint available = GL_FALSE;
+    glGetQueryObjectuiv(queries[current], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available)
+    {
+        glGetQueryObjectui64v(queries[current], GL_QUERY_RESULT, &lastSamples);
+        hasResult = true;
+    }
+    issued[current] = false;
+}
+
+bool OverdrawCounter::getSamples(GLuint64 &samples) const
+{
+    samples = lastSamples;
+    return hasResult;
+}
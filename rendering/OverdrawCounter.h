@@ -0,0 +1,32 @@
+#ifndef OVERDRAWCOUNTER_H
+#define OVERDRAWCOUNTER_H
+
+#include <glad/glad.h>
+
+/**
+ * Counts fragments that pass the depth test in a pass (GL_SAMPLES_PASSED)
+ * Two queries alternate so the result is read a frame late, never stalling
+ * the GPU. Divided by the pixel count this is the shading work per pixel
+ * (1.0 means every pixel was lit exactly once). Render thread only.
+ */
+class OverdrawCounter
+{
+public:
+    OverdrawCounter();
+    ~OverdrawCounter();
+
+    void begin();
+    void end();
+
+    // Newest finished result; false until one is available
+    bool getSamples(GLuint64 &samples) const;
+
+private:
+    GLuint queries[2];
+    bool issued[2];
+    int current;
+    GLuint64 lastSamples;
+    bool hasResult;
+};
+
+#endif
@@ -0,0 +1,138 @@
+#include "ProceduralTexture.h"
+#include "../Shader.h"
+#include "../models/Texture.h"
+#include <cstring>
+#include <iostream>
+
+ProceduralTexture::ProceduralTexture(const int *permutation, int unit)
+    : textureUnit(unit), packBuffer(0), packFence(0), packBytes(0)
+{
+    unsigned char table[256];
+    for (int i = 0; i < 256; i++)
+        table[i] = (unsigned char)permutation[i];
+
+    // Integer texture: read with texelFetch, never filtered
+    glGenTextures(1, &permutationTexture);
+    glBindTexture(GL_TEXTURE_2D, permutationTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8UI, 256, 1, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE, table);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &fbo);
+    glGenVertexArrays(1, &emptyVAO);
+    glGenBuffers(1, &packBuffer);
+}
+
+ProceduralTexture::~ProceduralTexture()
+{
+    glDeleteTextures(1, &permutationTexture);
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteVertexArrays(1, &emptyVAO);
+    if (packFence)
+        glDeleteSync(packFence);
+    glDeleteBuffers(1, &packBuffer);
+}
+
+bool ProceduralTexture::generate(Shader &program, const Texture &target, int width, int height)
+{
+    GLint previousFramebuffer, viewport[4];
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST), blend = glIsEnabled(GL_BLEND), cullFace = glIsEnabled(GL_CULL_FACE);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.ID, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cout << "ERROR::FRAMEBUFFER:: Procedural texture target is not renderable!" << std::endl;
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)previousFramebuffer);
+        return false;
+    }
+    glViewport(0, 0, width, height);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    glDisable(GL_CULL_FACE);
+
+    glActiveTexture(GL_TEXTURE0 + textureUnit);
+    glBindTexture(GL_TEXTURE_2D, permutationTexture);
+    glActiveTexture(GL_TEXTURE0);
+
+    program.use();
+    program.setInt("noisePermutation", textureUnit);
+    program.setVec2("targetSize", glm::vec2((float)width, (float)height));
+    glBindVertexArray(emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    // Detach so sampling the texture later is never a feedback loop
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)previousFramebuffer);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    if (depthTest)
+        glEnable(GL_DEPTH_TEST);
+    if (blend)
+        glEnable(GL_BLEND);
+    if (cullFace)
+        glEnable(GL_CULL_FACE);
+
+    glBindTexture(GL_TEXTURE_2D, target.ID);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
+
+void ProceduralTexture::readBack(const Texture &target, GLenum format, unsigned char *pixels, int level)
+{
+    glBindTexture(GL_TEXTURE_2D, target.ID);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glGetTexImage(GL_TEXTURE_2D, level, format, GL_UNSIGNED_BYTE, pixels);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void ProceduralTexture::beginReadBack(const Texture &target, GLenum format, int level, size_t bytes)
+{
+    if (packFence)
+        glDeleteSync(packFence);
+
+    // Fresh storage, so a copy still in flight is never waited on; with a
+    // pack buffer bound the pointer is an offset and the call returns at once
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, packBuffer);
+    glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)bytes, NULL, GL_STREAM_READ);
+    glBindTexture(GL_TEXTURE_2D, target.ID);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glGetTexImage(GL_TEXTURE_2D, level, format, GL_UNSIGNED_BYTE, (void *)0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    packFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    packBytes = bytes;
+}
+
+bool ProceduralTexture::finishReadBack(unsigned char *pixels)
+{
+    if (!packFence)
+        return false;
+    GLenum result = glClientWaitSync(packFence, 0, 0);
+    if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+        return false;
+    glDeleteSync(packFence);
+    packFence = 0;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, packBuffer);
+    const void *mapping = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)packBytes, GL_MAP_READ_BIT);
+    bool copied = mapping != nullptr;
+    if (copied)
+    {
+        std::memcpy(pixels, mapping, packBytes);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    else
+        std::cout << "ProceduralTexture: could not map readback buffer" << std::endl;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return copied;
+}
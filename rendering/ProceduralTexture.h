@@ -0,0 +1,55 @@
+#ifndef PROCEDURALTEXTURE_H
+#define PROCEDURALTEXTURE_H
+
+#include <glad/glad.h>
+#include <cstddef>
+
+class Shader;
+class Texture;
+
+/**
+ * Procedural textures rendered on the GPU instead of filled on the CPU
+ * generate() draws a fullscreen triangle with the given program into an
+ * existing 2D texture through the generator's framebuffer, then rebuilds
+ * its mipmaps. Targets should have a sized or RGBA format (an RGB one need
+ * not be renderable). Programs include noise.glsl, which evaluates the same Perlin
+ * noise and FBM as PerlinNoise from the permutation table bound here.
+ * Needs the GL context.
+ */
+class ProceduralTexture
+{
+public:
+    /**
+     * @param permutation PerlinNoise::getPermutation() (first 256 entries used)
+     * @param textureUnit Unit the table is bound to while generating
+     */
+    ProceduralTexture(const int *permutation, int textureUnit);
+    ~ProceduralTexture();
+
+    // The program's own uniforms are set by the caller; width and height
+    // must be the size of level 0 of target. False (and nothing drawn) when
+    // target's format cannot be rendered to
+    bool generate(Shader &program, const Texture &target, int width, int height);
+
+    // Copy a mip level back to memory (all its texels, in format). Waits
+    // for the GPU: for startup, not for frames
+    static void readBack(const Texture &target, GLenum format, unsigned char *pixels, int level = 0);
+
+    /**
+     * Stall-free readback: copies a mip level (bytes long in format) into a
+     * pack buffer and fences it. finishReadBack() never waits; it returns
+     * true once, with the texels in pixels, after the fence has signalled.
+     * A new request replaces one that has not finished.
+     */
+    void beginReadBack(const Texture &target, GLenum format, int level, size_t bytes);
+    bool finishReadBack(unsigned char *pixels);
+
+private:
+    int textureUnit;
+    GLuint fbo, permutationTexture, emptyVAO;
+    GLuint packBuffer;
+    GLsync packFence;
+    size_t packBytes;
+};
+
+#endif
@@ -0,0 +1,74 @@
+#include "RenderBenchmark.h"
+#include <iostream>
+
+RenderBenchmark::RenderBenchmark(const std::vector<std::string> &names, int warmup, int measured)
+    : pathNames(names), warmupFrames(warmup), measuredFrames(measured), frame(0),
+      gpuMs(names.size(), 0.0), cpuMs(names.size(), 0.0), samples(names.size(), 0)
+{
+    glGenQueries(2, queries);
+    queryPath[0] = queryPath[1] = -1;
+}
+
+RenderBenchmark::~RenderBenchmark()
+{
+    glDeleteQueries(2, queries);
+}
+
+int RenderBenchmark::currentPath() const
+{
+    int path = frame / (warmupFrames + measuredFrames);
+    return path < (int)pathNames.size() ? path : (int)pathNames.size() - 1;
+}
+
+bool RenderBenchmark::isFinished() const
+{
+    // One extra frame so the last measured query has been read back
+    return frame > (int)pathNames.size() * (warmupFrames + measuredFrames);
+}
+
+void RenderBenchmark::beginFrame()
+{
+    int slot = frame & 1;
+    glBeginQuery(GL_TIME_ELAPSED, queries[slot]);
+    frameStart = std::chrono::steady_clock::now();
+}
+
+void RenderBenchmark::endFrame()
+{
+    int slot = frame & 1;
+    glEndQuery(GL_TIME_ELAPSED);
+    std::chrono::duration<double, std::milli> cpu = std::chrono::steady_clock::now() - frameStart;
+
+    bool measured = (frame % (warmupFrames + measuredFrames)) >= warmupFrames &&
+                    frame < (int)pathNames.size() * (warmupFrames + measuredFrames);
+    queryPath[slot] = measured ? currentPath() : -1;
+    if (measured)
+        cpuMs[currentPath()] += cpu.count();
+
+    collect(slot ^ 1); // Previous frame's query
+    frame++;
+}
+
+void RenderBenchmark::collect(int slot)
+{
+    if (queryPath[slot] < 0)
+        return;
+
+    GLuint64 nanoseconds = 0;
+    glGetQueryObjectui64v(queries[slot], GL_QUERY_RESULT, &nanoseconds);
+    gpuMs[queryPath[slot]] += nanoseconds / 1.0e6;
+    samples[queryPath[slot]]++;
+    queryPath[slot] = -1;
+}
+
+void RenderBenchmark::printResults() const
+{
+    std::cout << "Renderer benchmark: " << measuredFrames << " frames per path after " << warmupFrames << " warmup" << std::endl;
+    std::cout << "path\tGPU ms\tCPU ms" << std::endl;
+    for (size_t i = 0; i < pathNames.size(); i++)
+    {
+        if (samples[i] == 0)
+            continue;
+        std::cout << pathNames[i] << "\t" << gpuMs[i] / samples[i] << "\t" << cpuMs[i] / samples[i] << std::endl;
+    }
+}
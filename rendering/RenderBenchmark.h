@@ -0,0 +1,45 @@
+#ifndef RENDERBENCHMARK_H
+#define RENDERBENCHMARK_H
+
+#include <glad/glad.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * Frame timing for comparing render paths on the same scene
+ * Runs warmup + measured frames per path in order. GPU time comes from
+ * GL_TIME_ELAPSED queries (read one frame late so the GPU is not stalled),
+ * CPU time is the render thread's submission time. Render thread only.
+ */
+class RenderBenchmark
+{
+public:
+    RenderBenchmark(const std::vector<std::string> &pathNames, int warmupFrames, int measuredFrames);
+    ~RenderBenchmark();
+
+    // Index into pathNames the current frame should use
+    int currentPath() const;
+    bool isFinished() const;
+
+    void beginFrame();
+    void endFrame();
+
+    void printResults() const;
+
+private:
+    void collect(int slot);
+
+    std::vector<std::string> pathNames;
+    int warmupFrames, measuredFrames;
+    int frame;
+
+    GLuint queries[2];
+    int queryPath[2];     // -1: slot holds no measured frame
+    std::chrono::steady_clock::time_point frameStart;
+
+    std::vector<double> gpuMs, cpuMs; // Totals per path
+    std::vector<int> samples;
+};
+
+#endif
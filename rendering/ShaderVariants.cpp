@@ -0,0 +1,34 @@
+#include "ShaderVariants.h"
+
+ShaderVariants::ShaderVariants(const std::string &vsPath, const std::string &fsPath,
+                               const std::vector<std::string> &names)
+    : vertexPath(vsPath), fragmentPath(fsPath), flagNames(names)
+{
+}
+
+ShaderVariants::~ShaderVariants()
+{
+    for (auto &variant : variants)
+    {
+        glDeleteProgram(variant.second->ID);
+        delete variant.second;
+    }
+}
+
+Shader &ShaderVariants::get(unsigned int flags)
+{
+    auto found = variants.find(flags);
+    if (found != variants.end())
+        return *found->second;
+
+    std::vector<std::string> defines;
+    for (size_t i = 0; i < flagNames.size(); i++)
+    {
+        if (flags & (1u << i))
+            defines.push_back(flagNames[i]);
+    }
+
+    Shader *shader = new Shader(vertexPath.c_str(), fragmentPath.c_str(), defines);
+    variants[flags] = shader;
+    return *shader;
+}
@@ -0,0 +1,32 @@
+#ifndef SHADERVARIANTS_H
+#define SHADERVARIANTS_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "../Shader.h"
+
+/**
+ * Compile-time permutations of one vertex/fragment source pair
+ * A variant is a bitmask over the flag names given at construction; bit i
+ * adds "#define flagNames[i]". Each combination compiles once, on first use,
+ * and is cached.
+ */
+class ShaderVariants
+{
+public:
+    ShaderVariants(const std::string &vertexPath, const std::string &fragmentPath,
+                   const std::vector<std::string> &flagNames);
+    ~ShaderVariants();
+
+    Shader &get(unsigned int flags);
+
+    size_t getVariantCount() const { return variants.size(); }
+
+private:
+    std::string vertexPath, fragmentPath;
+    std::vector<std::string> flagNames;
+    std::map<unsigned int, Shader *> variants;
+};
+
+#endif
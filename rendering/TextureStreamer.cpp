@@ -0,0 +1,180 @@
+#include "TextureStreamer.h"
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+    size_t bytesPerTexel(GLenum format)
+    {
+        switch (format)
+        {
+        case GL_RED:
+            return 1;
+        case GL_RG:
+            return 2;
+        case GL_RGB:
+            return 3;
+        default:
+            return 4;
+        }
+    }
+}
+
+TextureStreamer::TextureStreamer(size_t bytes, int slotCount)
+    : slotBytes(bytes), slots(std::max(1, slotCount)), uploads(0), running(true)
+{
+    for (Slot &slot : slots)
+    {
+        glGenBuffers(1, &slot.buffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)slotBytes, NULL, GL_STREAM_DRAW);
+        slot.mapping = nullptr;
+        slot.fence = 0;
+        slot.state = SLOT_FREE;
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    worker = std::thread(&TextureStreamer::workerLoop, this);
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    wake.notify_all();
+    worker.join(); // Lets a fill in progress finish writing its mapping
+
+    for (Slot &slot : slots)
+    {
+        if (slot.mapping)
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+        if (slot.fence)
+            glDeleteSync(slot.fence);
+        glDeleteBuffers(1, &slot.buffer);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+bool TextureStreamer::request(GLuint texture, int width, int height, GLenum format, Fill fill, bool generateMipmaps)
+{
+    if ((size_t)width * height * bytesPerTexel(format) > slotBytes)
+    {
+        std::cout << "TextureStreamer: " << width << "x" << height << " image does not fit a "
+                  << slotBytes / 1024 << " KB slot" << std::endl;
+        return false;
+    }
+
+    Request next = {texture, width, height, format, fill, generateMipmaps};
+    std::lock_guard<std::mutex> lock(mutex);
+    for (Request &queued : requests)
+    {
+        if (queued.texture == texture)
+        {
+            queued = next; // Only the newest image is worth uploading
+            return true;
+        }
+    }
+    requests.push_back(next);
+    return true;
+}
+
+void TextureStreamer::update()
+{
+    for (Slot &slot : slots)
+    {
+        int state = slot.state.load(std::memory_order_acquire);
+        if (state == SLOT_FILLED)
+        {
+            const Request &r = slot.request;
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+            GLboolean intact = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            slot.mapping = nullptr;
+            if (intact)
+            {
+                // Source is the bound buffer: the pointer is an offset into it
+                glBindTexture(GL_TEXTURE_2D, r.texture);
+                glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, r.width, r.height, r.format, GL_UNSIGNED_BYTE, (void *)0);
+                glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+                if (r.generateMipmaps)
+                    glGenerateMipmap(GL_TEXTURE_2D);
+                glBindTexture(GL_TEXTURE_2D, 0);
+                uploads++;
+            }
+            else
+                std::cout << "TextureStreamer: buffer contents lost, upload dropped" << std::endl;
+
+            slot.request.fill = nullptr;
+            slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            slot.state = SLOT_IN_FLIGHT;
+        }
+        else if (state == SLOT_IN_FLIGHT)
+        {
+            GLenum result = glClientWaitSync(slot.fence, 0, 0);
+            if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED)
+            {
+                glDeleteSync(slot.fence);
+                slot.fence = 0;
+                slot.state = SLOT_FREE;
+            }
+        }
+    }
+
+    bool queuedFill = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < slots.size() && !requests.empty(); i++)
+        {
+            Slot &slot = slots[i];
+            if (slot.state.load(std::memory_order_relaxed) != SLOT_FREE)
+                continue;
+
+            // The fence has signalled, so the GPU is done reading this buffer
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+            void *mapping = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)slotBytes,
+                                             GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+            if (!mapping)
+            {
+                std::cout << "TextureStreamer: could not map upload buffer" << std::endl;
+                break;
+            }
+
+            slot.mapping = static_cast<unsigned char *>(mapping);
+            slot.request = requests.front();
+            requests.pop_front();
+            slot.state = SLOT_MAPPED;
+            fills.push_back((int)i);
+            queuedFill = true;
+        }
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if (queuedFill)
+        wake.notify_one();
+}
+
+void TextureStreamer::workerLoop()
+{
+    for (;;)
+    {
+        int index;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]()
+                      { return !running || !fills.empty(); });
+            if (!running)
+                return;
+            index = fills.front();
+            fills.pop_front();
+        }
+
+        Slot &slot = slots[index];
+        slot.request.fill(slot.mapping);
+        slot.state.store(SLOT_FILLED, std::memory_order_release);
+    }
+}
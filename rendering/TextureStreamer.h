@@ -0,0 +1,92 @@
+#ifndef TEXTURESTREAMER_H
+#define TEXTURESTREAMER_H
+
+#include <glad/glad.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Runtime texture replacement through a ring of pixel-unpack buffers
+ * A request names a texture and a fill function for its level-0 texels.
+ * The GL thread maps a free buffer of the ring, the streamer's own worker
+ * thread runs the fill straight into that mapping, and a later update()
+ * unmaps it and issues glTexSubImage2D from the buffer, so the GL thread
+ * never waits for the pixels or for the copy. Every slot is fenced after its
+ * upload and only mapped again once the fence has signalled.
+ * request() may be called from any thread, a running fill included;
+ * update() and the destructor need the GL context.
+ */
+class TextureStreamer
+{
+public:
+    // Writes width * height tightly packed texels of the request's format
+    typedef std::function<void(unsigned char *pixels)> Fill;
+
+    /**
+     * @param slotBytes Largest image a single request may upload
+     * @param slotCount Buffers in the ring (uploads in flight at once)
+     */
+    explicit TextureStreamer(size_t slotBytes, int slotCount = 3);
+    ~TextureStreamer();
+
+    /**
+     * Queue a replacement of level 0 of texture (format GL_RED, GL_RG, GL_RGB
+     * or GL_RGBA, unsigned bytes). A queued request for the same texture that
+     * has not started yet is replaced. False if the image exceeds a slot.
+     */
+    bool request(GLuint texture, int width, int height, GLenum format, Fill fill, bool generateMipmaps = true);
+
+    // Once per frame: upload filled slots, retire signalled ones and map free
+    // slots for queued requests. Never blocks.
+    void update();
+
+    int getUploadCount() const { return uploads; }
+
+private:
+    enum SlotState
+    {
+        SLOT_FREE,
+        SLOT_MAPPED,   // Worker is (or will be) filling the mapping
+        SLOT_FILLED,   // Ready for glTexSubImage2D
+        SLOT_IN_FLIGHT // Upload issued, fence pending
+    };
+
+    struct Request
+    {
+        GLuint texture;
+        int width, height;
+        GLenum format;
+        Fill fill;
+        bool generateMipmaps;
+    };
+
+    struct Slot
+    {
+        GLuint buffer;
+        unsigned char *mapping;
+        GLsync fence;
+        Request request;
+        std::atomic<int> state;
+    };
+
+    void workerLoop();
+
+    size_t slotBytes;
+    std::vector<Slot> slots;
+    int uploads;
+
+    std::mutex mutex;
+    std::deque<Request> requests; // Waiting for a free slot
+    std::deque<int> fills;        // Mapped slots for the worker
+    std::condition_variable wake;
+    bool running;
+    std::thread worker;
+};
+
+#endif
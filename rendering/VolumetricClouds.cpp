@@ -0,0 +1,179 @@
+#include "VolumetricClouds.h"
+#include "../Shader.h"
+#include <algorithm>
+#include <iostream>
+
+VolumetricClouds::VolumetricClouds(int w, int h)
+    : width(w), height(h), lowWidth(std::max(1, w / 2)), lowHeight(std::max(1, h / 2)),
+      noiseVolume(0), current(0), historyValid(false), frameIndex(0), prevViewProjection(1.0f)
+{
+    // Storage comes from allocateTargets, so resize() can redo it
+    glGenTextures(1, &depthTexture);
+    glGenTextures(2, historyTextures);
+    allocateTargets();
+
+    // Full-resolution scene depth, in the window's layout so it can be blitted
+    glGenFramebuffers(1, &depthFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, depthFbo);
+    glBindTexture(GL_TEXTURE_2D, depthTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::FRAMEBUFFER:: Cloud depth framebuffer is not complete!" << std::endl;
+
+    // Quarter-resolution history (premultiplied colour, coverage), ping-ponged
+    glGenFramebuffers(2, historyFbos);
+    for (int i = 0; i < 2; i++)
+    {
+        glBindTexture(GL_TEXTURE_2D, historyTextures[i]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, historyFbos[i]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, historyTextures[i], 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "ERROR::FRAMEBUFFER:: Cloud history framebuffer is not complete!" << std::endl;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenVertexArrays(1, &emptyVAO);
+}
+
+VolumetricClouds::~VolumetricClouds()
+{
+    glDeleteFramebuffers(1, &depthFbo);
+    glDeleteTextures(1, &depthTexture);
+    glDeleteFramebuffers(2, historyFbos);
+    glDeleteTextures(2, historyTextures);
+    if (noiseVolume != 0)
+        glDeleteTextures(1, &noiseVolume);
+    glDeleteVertexArrays(1, &emptyVAO);
+}
+
+void VolumetricClouds::allocateTargets()
+{
+    glBindTexture(GL_TEXTURE_2D, depthTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, width, height, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL);
+    for (int i = 0; i < 2; i++)
+    {
+        glBindTexture(GL_TEXTURE_2D, historyTextures[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, lowWidth, lowHeight, 0, GL_RGBA, GL_FLOAT, NULL);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void VolumetricClouds::resize(int w, int h)
+{
+    if (w == width && h == height)
+        return;
+    width = w;
+    height = h;
+    lowWidth = std::max(1, w / 2);
+    lowHeight = std::max(1, h / 2);
+    allocateTargets();
+    historyValid = false; // Old history no longer lines up with the pixels
+}
+
+void VolumetricClouds::setNoiseVolume(const unsigned char *voxels)
+{
+    if (noiseVolume == 0)
+        glGenTextures(1, &noiseVolume);
+
+    glBindTexture(GL_TEXTURE_3D, noiseVolume);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage3D(GL_TEXTURE_3D, 0, GL_R8, NOISE_SIZE, NOISE_SIZE, NOISE_SIZE, 0, GL_RED, GL_UNSIGNED_BYTE, voxels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glGenerateMipmap(GL_TEXTURE_3D);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_REPEAT);
+    glBindTexture(GL_TEXTURE_3D, 0);
+}
+
+void VolumetricClouds::captureDepth(GLuint framebuffer)
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, depthFbo);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+}
+
+void VolumetricClouds::march(Shader &marchShader, const glm::mat4 &viewProjection, glm::vec3 viewPos, int firstUnit)
+{
+    int previous = current;
+    current = 1 - current;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, historyFbos[current]);
+    glViewport(0, 0, lowWidth, lowHeight);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+
+    marchShader.use();
+    glActiveTexture(GL_TEXTURE0 + firstUnit);
+    glBindTexture(GL_TEXTURE_3D, noiseVolume);
+    marchShader.setInt("noiseVolume", firstUnit);
+    glActiveTexture(GL_TEXTURE0 + firstUnit + 1);
+    glBindTexture(GL_TEXTURE_2D, depthTexture);
+    marchShader.setInt("sceneDepth", firstUnit + 1);
+    glActiveTexture(GL_TEXTURE0 + firstUnit + 2);
+    glBindTexture(GL_TEXTURE_2D, historyTextures[previous]);
+    marchShader.setInt("history", firstUnit + 2);
+    glActiveTexture(GL_TEXTURE0);
+
+    marchShader.setMat4("inverseViewProjection", glm::inverse(viewProjection));
+    marchShader.setMat4("prevViewProjection", prevViewProjection);
+    marchShader.setVec3("viewPos", viewPos);
+    marchShader.setBool("historyValid", historyValid);
+    marchShader.setFloat("frameIndex", (float)(frameIndex++ % 1024));
+
+    glBindVertexArray(emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+
+    prevViewProjection = viewProjection;
+    historyValid = true;
+}
+
+void VolumetricClouds::composite(Shader &compositeShader, GLuint framebuffer, int firstUnit) const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, width, height);
+
+    compositeShader.use();
+    glActiveTexture(GL_TEXTURE0 + firstUnit);
+    glBindTexture(GL_TEXTURE_2D, historyTextures[current]);
+    compositeShader.setInt("cloudBuffer", firstUnit);
+    glActiveTexture(GL_TEXTURE0 + firstUnit + 1);
+    glBindTexture(GL_TEXTURE_2D, depthTexture);
+    compositeShader.setInt("sceneDepth", firstUnit + 1);
+    glActiveTexture(GL_TEXTURE0);
+    compositeShader.setVec2("lowResSize", glm::vec2((float)lowWidth, (float)lowHeight));
+
+    // Premultiplied colour over the frame; the triangle itself is not depth tested
+    glDisable(GL_DEPTH_TEST);
+    glDepthMask(GL_FALSE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    glBindVertexArray(emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDepthMask(GL_TRUE);
+    glEnable(GL_DEPTH_TEST);
+}
@@ -0,0 +1,59 @@
+#ifndef VOLUMETRICCLOUDS_H
+#define VOLUMETRICCLOUDS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+class Shader;
+
+/**
+ * Raymarched cloud layers at quarter resolution
+ * The 200-350 m cloud band is marched through a small tiling 3D noise
+ * volume at half width and half height, so the cost follows the pixel count
+ * instead of the number of clouds. Each frame's march (with a jittered start)
+ * is blended with the previous result reprojected through last frame's
+ * view-projection; a depth-aware upsample then composites the clouds over
+ * the full-resolution frame without bleeding across geometry edges.
+ */
+class VolumetricClouds
+{
+public:
+    static const int NOISE_SIZE = 64; // Texels per side of the noise volume
+
+    VolumetricClouds(int width, int height);
+    ~VolumetricClouds();
+
+    // Reallocate for a new frame size; history restarts
+    void resize(int width, int height);
+
+    // NOISE_SIZE^3 bytes, x fastest; must tile in every direction
+    void setNoiseVolume(const unsigned char *voxels);
+
+    // Copy the scene depth (DEPTH24_STENCIL8 layout) the clouds test against
+    void captureDepth(GLuint framebuffer);
+
+    // March into the next history target, blending in the reprojected one;
+    // uses texture units firstUnit..firstUnit+2
+    void march(Shader &marchShader, const glm::mat4 &viewProjection, glm::vec3 viewPos, int firstUnit);
+
+    // Depth-aware upsample, premultiplied-alpha blended over framebuffer
+    void composite(Shader &compositeShader, GLuint framebuffer, int firstUnit) const;
+
+private:
+    void allocateTargets();
+
+    int width, height;
+    int lowWidth, lowHeight;
+
+    GLuint noiseVolume;
+    GLuint depthFbo, depthTexture;
+    GLuint historyFbos[2], historyTextures[2];
+    int current;       // History target written by the last march
+    bool historyValid; // False until the first march
+    unsigned int frameIndex;
+    glm::mat4 prevViewProjection;
+
+    GLuint emptyVAO;
+};
+
+#endif
@@ -0,0 +1,40 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in vec4 aPositionYaw; // Per instance: xyz = position, w = heading
+layout (location = 4) in vec4 aFlapPitch;   // Per instance: x = wing angle (deg), y = pitch
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+
+// Bit-identical depth in the pre-pass and colour pass (GL_EQUAL test)
+invariant gl_Position;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+// Part layout (Bird::partOffset / partFlapSign / partTiltDegrees)
+uniform vec3 partOffset;
+uniform float partFlapSign;
+uniform float partTilt; // Radians
+
+mat3 rotateX(float a) { float c = cos(a), s = sin(a); return mat3(1.0, 0.0, 0.0, 0.0, c, s, 0.0, -s, c); }
+mat3 rotateY(float a) { float c = cos(a), s = sin(a); return mat3(c, 0.0, -s, 0.0, 1.0, 0.0, s, 0.0, c); }
+mat3 rotateZ(float a) { float c = cos(a), s = sin(a); return mat3(c, s, 0.0, -s, c, 0.0, 0.0, 0.0, 1.0); }
+
+void main()
+{
+    // body = translate(position) * rotateY(heading) * rotateX(-pitch)  (nose follows velocity)
+    mat3 bodyRot = rotateY(aPositionYaw.w) * rotateX(-aFlapPitch.y);
+    // part = translate(partOffset) * rotateZ(flap) * rotateX(tilt)
+    mat3 partRot = rotateZ(radians(aFlapPitch.x) * partFlapSign) * rotateX(partTilt);
+
+    mat3 rot = bodyRot * partRot;
+    FragPos = aPositionYaw.xyz + bodyRot * (partOffset + partRot * aPos);
+    Normal = rot * aNormal; // Pure rotation: no inverse-transpose needed
+    TexCoords = aTexCoords;
+
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
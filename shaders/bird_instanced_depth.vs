@@ -0,0 +1,24 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in vec4 aPositionYaw;
+layout (location = 4) in vec4 aFlapPitch;
+
+uniform mat4 lightSpaceMatrix;
+
+uniform vec3 partOffset;
+uniform float partFlapSign;
+uniform float partTilt;
+
+// Same layout as bird_instanced.vs
+mat3 rotateX(float a) { float c = cos(a), s = sin(a); return mat3(1.0, 0.0, 0.0, 0.0, c, s, 0.0, -s, c); }
+mat3 rotateY(float a) { float c = cos(a), s = sin(a); return mat3(c, 0.0, -s, 0.0, 1.0, 0.0, s, 0.0, c); }
+mat3 rotateZ(float a) { float c = cos(a), s = sin(a); return mat3(c, s, 0.0, -s, c, 0.0, 0.0, 0.0, 1.0); }
+
+void main()
+{
+    mat3 bodyRot = rotateY(aPositionYaw.w) * rotateX(-aFlapPitch.y);
+    mat3 partRot = rotateZ(radians(aFlapPitch.x) * partFlapSign) * rotateX(partTilt);
+    vec3 worldPos = aPositionYaw.xyz + bodyRot * (partOffset + partRot * aPos);
+
+    gl_Position = lightSpaceMatrix * vec4(worldPos, 1.0);
+}
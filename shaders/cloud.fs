@@ -2,21 +2,21 @@
 out vec4 FragColor;
 
 in vec2 TexCoords;
+in vec2 QuadPos;
 in vec3 FragPos;
-in vec3 Normal;
+flat in float Impostor;
 
-uniform sampler2D cloudTexture;
+uniform sampler2D cloudTexture;  // Single puff (near particles)
+uniform sampler2D impostorAtlas; // Baked streaks (far clouds)
 uniform vec3 viewPos;
 uniform float time;
 uniform vec3 skyColor; // Sky color for matching cloud color to time of day
+uniform float softDistance; // Particles fade out as the camera comes this close
 
 void main()
 {
-    // Sample cloud texture
-    vec4 texColor = texture(cloudTexture, TexCoords);
-    
-    // Use luminance as alpha for soft transparency
-    float luminance = texColor.r; // Grayscale texture, so R = G = B
+    // Grayscale textures, so R = G = B
+    float luminance = Impostor > 0.5 ? texture(impostorAtlas, TexCoords).r : texture(cloudTexture, TexCoords).r;
     
     // Soft alpha falloff - makes edges very soft
     float alpha = smoothstep(0.1, 0.7, luminance);
@@ -31,12 +31,8 @@ void main()
     float skyBrightness = (skyColor.r + skyColor.g + skyColor.b) / 3.0;
     vec3 cloudColor = mix(nightCloudColor, dayCloudColor, smoothstep(0.1, 0.4, skyBrightness));
     
-    // Subtle lighting based on view angle (rim lighting effect)
-    vec3 viewDir = normalize(viewPos - FragPos);
-    float rim = 1.0 - max(dot(normalize(Normal), viewDir), 0.0);
-    rim = smoothstep(0.6, 1.0, rim);
-    
-    // Add subtle brightness variation based on rim (less pronounced at night)
+    // Brighter thin edges stand in for the rim lighting of the old ellipsoids
+    float rim = smoothstep(0.6, 1.0, max(1.0 - alpha, length(QuadPos)));
     cloudColor += rim * 0.15 * skyBrightness;
     
     // Optional: Add very subtle time-based shimmer (only during day)
@@ -46,8 +42,11 @@ void main()
     // Clamp to prevent over-brightness
     cloudColor = clamp(cloudColor, 0.0, 1.0);
     
+    // Soft particles: fade instead of clipping when the camera flies through
+    float soft = smoothstep(0.0, softDistance, distance(viewPos, FragPos));
+    
     // Final color with alpha (more transparent at night)
-    float finalAlpha = alpha * mix(0.6, 0.85, skyBrightness);
+    float finalAlpha = alpha * soft * mix(0.6, 0.85, skyBrightness);
     FragColor = vec4(cloudColor, finalAlpha);
     
     // Discard very transparent fragments for performance
@@ -1,21 +1,33 @@
 #version 330 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
+layout (location = 0) in vec3 aPos;       // Unit quad corner (-1..1)
 layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in vec4 aCenterHalfWidth; // Per sprite (CloudImpostors::Sprite)
+layout (location = 4) in vec4 aRightHalfHeight;
+layout (location = 5) in vec4 aTile;
+layout (location = 6) in vec4 aParams;
 
 out vec2 TexCoords;
+out vec2 QuadPos;
 out vec3 FragPos;
-out vec3 Normal;
+flat out float Impostor;
 
-uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
+uniform vec3 viewPos;
 
 void main()
 {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
-    TexCoords = aTexCoords;
-    
+    // Camera-facing, rotated about the view ray so the streak axis stays on
+    // screen (same axes as CloudImpostors::build, which sized the sprite)
+    vec3 center = aCenterHalfWidth.xyz;
+    vec3 toCamera = normalize(viewPos - center);
+    vec3 right = aRightHalfHeight.xyz;
+    vec3 up = cross(toCamera, right);
+
+    FragPos = center + right * (aPos.x * aCenterHalfWidth.w) + up * (aPos.y * aRightHalfHeight.w);
+    TexCoords = aTile.xy + aTexCoords * aTile.zw;
+    QuadPos = aPos.xy;
+    Impostor = aParams.x;
+
     gl_Position = projection * view * vec4(FragPos, 1.0);
 }
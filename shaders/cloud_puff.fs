@@ -0,0 +1,27 @@
+#version 330 core
+out vec4 FragColor;
+
+#include "noise.glsl"
+
+// Sprite-path cloud puff; the same steps and parameters as
+// GenerateCloudTexture in main.cpp
+uniform vec2 targetSize;
+uniform float scale;     // Noise cells across the texture
+uniform int octaves;
+uniform float seed;      // Slice through the 3D noise
+uniform vec2 mask;       // Radial fade, centre to edge
+uniform vec2 threshold;  // Smoothstep on the masked noise
+uniform float contrast;
+
+void main()
+{
+    // Texel corners, as the CPU loop samples them
+    vec2 uv = (gl_FragCoord.xy - 0.5) / targetSize;
+    float dist = length(uv * 2.0 - 1.0);
+
+    float n = Fbm(vec3(uv * scale, seed), octaves) * 0.5 + 0.5;
+    float intensity = n * (1.0 - smoothstep(mask.x, mask.y, dist));
+    intensity = pow(smoothstep(threshold.x, threshold.y, intensity), contrast);
+
+    FragColor = vec4(vec3(clamp(intensity, 0.0, 1.0)), 1.0);
+}
@@ -0,0 +1,35 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D cloudBuffer; // Quarter resolution, premultiplied
+uniform sampler2D sceneDepth;  // Full resolution
+uniform vec2 lowResSize;
+
+// Bilinear weights of the 4 nearest low-resolution texels, each scaled down
+// when the depth it was marched against differs from this pixel's depth,
+// so clouds neither bleed onto geometry edges nor get cut by them
+void main()
+{
+    float depth = texture(sceneDepth, TexCoords).r;
+
+    vec2 lowPos = TexCoords * lowResSize - 0.5;
+    vec2 base = floor(lowPos);
+    vec2 f = lowPos - base;
+
+    vec4 sum = vec4(0.0);
+    float weightSum = 0.0;
+    for (int i = 0; i < 4; i++)
+    {
+        vec2 offset = vec2(i & 1, i >> 1);
+        vec2 uv = (base + offset + 0.5) / lowResSize;
+        vec2 bilinear = mix(1.0 - f, f, offset);
+        float sampleDepth = texture(sceneDepth, uv).r;
+        float weight = bilinear.x * bilinear.y / (1e-4 + abs(sampleDepth - depth) * 1000.0);
+        sum += texture(cloudBuffer, uv) * weight;
+        weightSum += weight;
+    }
+
+    FragColor = weightSum > 0.0 ? sum / weightSum : vec4(0.0);
+}
@@ -0,0 +1,127 @@
+#version 330 core
+out vec4 FragColor; // Premultiplied cloud colour, a = coverage
+
+in vec2 TexCoords;
+
+// Drawn at quarter resolution by VolumetricClouds::march
+uniform sampler3D noiseVolume; // Tiling Perlin FBM
+uniform sampler2D sceneDepth;  // Full resolution; the march stops at geometry
+uniform sampler2D history;     // Last frame's result
+uniform mat4 inverseViewProjection;
+uniform mat4 prevViewProjection;
+uniform vec3 viewPos;
+uniform bool historyValid;
+uniform float frameIndex;
+
+uniform vec3 sunDir;
+uniform vec3 skyColor;
+uniform float time;
+uniform float coverage; // 0 = clear sky, 1 = overcast
+
+// The two cloud bands (main.cpp used to place ellipsoids at these heights)
+const vec2 LOW_BAND = vec2(200.0, 260.0);
+const vec2 HIGH_BAND = vec2(280.0, 350.0);
+const float MAX_DISTANCE = 4000.0;
+const int STEPS = 32;
+const float SHAPE_SCALE = 1.0 / 900.0;  // One noise tile per 900 m
+const float DETAIL_SCALE = 1.0 / 170.0;
+const float EXTINCTION = 0.04;
+const float HISTORY_WEIGHT = 0.85;
+
+float band(float y, vec2 range)
+{
+    float fade = (range.y - range.x) * 0.25;
+    return smoothstep(range.x, range.x + fade, y) * (1.0 - smoothstep(range.y - fade, range.y, y));
+}
+
+float density(vec3 p)
+{
+    float profile = max(band(p.y, LOW_BAND), band(p.y, HIGH_BAND));
+    if (profile <= 0.0)
+        return 0.0;
+
+    // Drift along +X like the old ellipsoid clouds
+    vec3 wind = vec3(time * 3.0, 0.0, time * 0.5);
+    float shape = texture(noiseVolume, (p + wind) * SHAPE_SCALE).r;
+    float detail = texture(noiseVolume, (p + wind * 1.6) * DETAIL_SCALE).r;
+
+    float d = shape * profile - (1.0 - coverage);
+    d -= (1.0 - detail) * 0.12; // Erode the edges
+    return max(d, 0.0);
+}
+
+vec3 worldAt(vec2 uv, float depth)
+{
+    vec4 p = inverseViewProjection * vec4(vec3(uv, depth) * 2.0 - 1.0, 1.0);
+    return p.xyz / p.w;
+}
+
+float jitter(vec2 p)
+{
+    return fract(sin(dot(p, vec2(12.9898, 78.233))) * 43758.5453);
+}
+
+void main()
+{
+    float depth = texture(sceneDepth, TexCoords).r;
+    vec3 dir = normalize(worldAt(TexCoords, 1.0) - viewPos);
+    float maxT = MAX_DISTANCE;
+    if (depth < 1.0)
+        maxT = min(maxT, length(worldAt(TexCoords, depth) - viewPos));
+
+    // Ray against the slab holding both bands
+    float tEnter = 0.0, tExit = 0.0;
+    if (abs(dir.y) > 1e-4)
+    {
+        float t0 = (LOW_BAND.x - viewPos.y) / dir.y;
+        float t1 = (HIGH_BAND.y - viewPos.y) / dir.y;
+        tEnter = max(min(t0, t1), 0.0);
+        tExit = min(max(t0, t1), maxT);
+    }
+    else if (viewPos.y > LOW_BAND.x && viewPos.y < HIGH_BAND.y)
+    {
+        tExit = maxT;
+    }
+
+    // Day: white, night: a little lighter than the sky (as the sprite clouds)
+    float skyBrightness = (skyColor.r + skyColor.g + skyColor.b) / 3.0;
+    vec3 cloudColor = mix(skyColor * 0.3, vec3(1.0), smoothstep(0.1, 0.4, skyBrightness));
+
+    vec3 color = vec3(0.0);
+    float transmittance = 1.0;
+    float weightedT = 0.0;
+    if (tExit > tEnter)
+    {
+        float stepSize = (tExit - tEnter) / float(STEPS);
+        // A different start offset every frame; the history averages them
+        float t = tEnter + stepSize * fract(jitter(gl_FragCoord.xy) + frameIndex * 0.618034);
+        for (int i = 0; i < STEPS; i++)
+        {
+            vec3 p = viewPos + dir * t;
+            float d = density(p);
+            if (d > 0.0)
+            {
+                // One sample towards the sun for self-shadowing
+                float lit = exp(-density(p + sunDir * 40.0) * 40.0 * EXTINCTION * 4.0);
+                float alpha = 1.0 - exp(-d * stepSize * EXTINCTION);
+                color += transmittance * alpha * cloudColor * mix(0.55, 1.0, lit);
+                weightedT += transmittance * alpha * t;
+                transmittance *= 1.0 - alpha;
+                if (transmittance < 0.01)
+                    break;
+            }
+            t += stepSize;
+        }
+    }
+
+    vec4 result = vec4(color, 1.0 - transmittance);
+
+    // Reproject through the cloud's mean depth (or where the ray enters the band)
+    float hitT = result.a > 0.001 ? weightedT / result.a : (tExit > tEnter ? tEnter : maxT);
+    vec4 prevClip = prevViewProjection * vec4(viewPos + dir * hitT, 1.0);
+    vec2 prevUV = prevClip.xy / prevClip.w * 0.5 + 0.5;
+    if (historyValid && prevClip.w > 0.0 && all(greaterThan(prevUV, vec2(0.0))) && all(lessThan(prevUV, vec2(1.0))))
+        result = mix(result, texture(history, prevUV), HISTORY_WEIGHT);
+
+    FragColor = result;
+}
@@ -0,0 +1,39 @@
+#version 330 core
+out vec4 FragColor;
+
+// One street light over the pixels its volume covers (additive blending)
+
+#include "lights.glsl"
+#include "gbuffer.glsl"
+
+flat in vec4 Light0;
+flat in vec4 Light1;
+flat in vec4 Light2;
+flat in vec4 Light3;
+
+uniform vec3 viewPos;
+uniform vec2 viewportSize;
+
+void main()
+{
+    GSample g;
+    if (!ReadGBuffer(gl_FragCoord.xy / viewportSize, g))
+        discard;
+
+    PointLight light;
+    light.position = Light0.xyz;
+    light.radius = Light0.w;
+    light.ambient = Light1.xyz;
+    light.constant = Light1.w;
+    light.diffuse = Light2.xyz;
+    light.linear = Light2.w;
+    light.specular = Light3.xyz;
+    light.quadratic = Light3.w;
+
+    // The volume covers pixels in front of and behind the sphere too
+    if (distance(light.position, g.position) > light.radius)
+        discard;
+
+    vec3 viewDir = normalize(viewPos - g.position);
+    FragColor = vec4(CalcPointLight(light, g.normal, g.position, viewDir, g.albedo, g.shininess), 1.0);
+}
@@ -0,0 +1,28 @@
+#version 330 core
+// Street light volume: unit sphere scaled to the light's radius, one
+// instance per light (the 4 texels per light of LightClusters::Grid)
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in vec4 aLight0; // position, radius
+layout (location = 4) in vec4 aLight1; // ambient, constant
+layout (location = 5) in vec4 aLight2; // diffuse, linear
+layout (location = 6) in vec4 aLight3; // specular, quadratic
+
+flat out vec4 Light0;
+flat out vec4 Light1;
+flat out vec4 Light2;
+flat out vec4 Light3;
+
+uniform mat4 projection;
+uniform mat4 view;
+uniform float volumeScale; // Pushes the tessellated sphere outside the true radius
+
+void main()
+{
+    Light0 = aLight0;
+    Light1 = aLight1;
+    Light2 = aLight2;
+    Light3 = aLight3;
+
+    vec3 worldPos = aLight0.xyz + aPos * aLight0.w * volumeScale;
+    gl_Position = projection * view * vec4(worldPos, 1.0);
+}
@@ -0,0 +1,37 @@
+#version 330 core
+out vec4 FragColor;
+
+// Fullscreen deferred pass: sun with shadow, emission and (variant) the
+// flag spotlight. Street lights are added by deferred_point.fs volumes.
+// Variants:
+//   NIGHT_LIGHTS - flag spotlight
+//   SHADOW_TAPS_1 / SHADOW_POISSON_16 - shadow filter quality (see shadow.glsl)
+
+#include "lights.glsl"
+#include "shadow.glsl"
+#include "gbuffer.glsl"
+
+in vec2 TexCoords;
+
+uniform vec3 viewPos;
+uniform DirLight dirLight;
+uniform SpotLight spotLight;
+
+void main()
+{
+    GSample g;
+    if (!ReadGBuffer(TexCoords, g))
+        discard; // Keep the clear colour
+
+    vec3 viewDir = normalize(viewPos - g.position);
+    vec3 lightDir = normalize(-dirLight.direction);
+    float shadow = ShadowCalculation(g.position, g.normal, lightDir);
+
+    vec3 result = CalcDirLight(dirLight, g.normal, viewDir, shadow, g.albedo, g.shininess);
+#ifdef NIGHT_LIGHTS
+    result += CalcSpotLight(spotLight, g.normal, g.position, viewDir, g.albedo, g.shininess);
+#endif
+    result += g.emissive;
+
+    FragColor = vec4(result, 1.0);
+}
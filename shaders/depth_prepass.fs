@@ -0,0 +1,22 @@
+#version 330 core
+// Depth pre-pass: depth only, drawn with the same vertex shaders as the
+// colour pass so its GL_EQUAL test matches exactly
+
+#include "material.glsl"
+
+struct Material {
+    sampler2D diffuse;
+    sampler2D specular;
+    float shininess;
+}; 
+
+in vec2 TexCoords;
+
+uniform Material material;
+
+void main()
+{
+    // Transparent texels must not hide what is behind them
+    if (SampleDiffuse(material.diffuse, TexCoords).a < 0.5)
+        discard;
+}
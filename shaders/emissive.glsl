@@ -0,0 +1,46 @@
+// emissive.glsl - self-lit surfaces shared by the forward and G-buffer shaders
+// (pulled in with #include by the Shader class, so no version line here)
+
+// Simple hash for pseudo-random window lights
+float hash(vec2 p) {
+    return fract(sin(dot(p, vec2(127.1, 311.7))) * 43758.5453);
+}
+
+// Building window lights at night
+vec3 WindowEmission(vec2 texCoords, float time)
+{
+    // Create window grid pattern using texture coordinates
+    // Reduced grid: 3 columns x 6 rows (less dense)
+    vec2 windowGrid = fract(texCoords * vec2(3.0, 6.0));
+    
+    // Window frame (dark borders) - larger borders for more spacing
+    float windowFrame = step(0.15, windowGrid.x) * step(windowGrid.x, 0.85) *
+                       step(0.15, windowGrid.y) * step(windowGrid.y, 0.85);
+    
+    // Random window on/off state (based on grid position)
+    vec2 gridCell = floor(texCoords * vec2(3.0, 6.0));
+    float randomState = hash(gridCell);
+    
+    // Only 35% of windows are lit at night (more sparse)
+    float isLit = step(0.65, randomState);
+    
+    // Slight flicker for realism
+    float flicker = 0.9 + 0.1 * sin(time * 3.0 + randomState * 100.0);
+    
+    // Improved window light colors - more natural
+    vec3 windowLight;
+    if (randomState < 0.7) {
+        // Warm incandescent (70%) - soft yellow
+        windowLight = vec3(1.0, 0.8, 0.5);
+    } else if (randomState < 0.9) {
+        // Neutral white (20%) - LED/fluorescent
+        windowLight = vec3(0.95, 0.95, 0.85);
+    } else {
+        // Cool white (10%) - modern LED
+        windowLight = vec3(0.85, 0.9, 1.0);
+    }
+    windowLight *= 0.6; // Reduced intensity for subtlety
+    
+    float windowIntensity = windowFrame * isLit * flicker;
+    return windowLight * windowIntensity;
+}
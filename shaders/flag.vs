@@ -0,0 +1,48 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+
+// Bit-identical depth in the pre-pass and colour pass (GL_EQUAL test)
+invariant gl_Position;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+uniform float waveTime;  // CotCo wave phase (advances 2 rad/s)
+uniform float flagRaise; // Height of the flag's top edge above the pole base
+uniform float flagWidth; // Cloth length from pole (hoist) to free edge (fly)
+
+// Travelling wave along the cloth; amplitude grows away from the pole
+const float AMPLITUDE = 0.22;
+const float WAVE_NUMBER = 2.6;    // Radians per unit along X
+const float VERTICAL_SKEW = 0.7;  // Phase shift per unit along Y (diagonal ripples)
+
+void main()
+{
+    float s = aPos.x / flagWidth; // 0 at pole, 1 at free edge
+    float amp = AMPLITUDE * s;
+    float phase = WAVE_NUMBER * aPos.x + VERTICAL_SKEW * aPos.y - waveTime * 2.0;
+
+    // Displacement out of the cloth plane
+    float z = amp * sin(phase);
+
+    // Analytic partial derivatives give the bent surface normal
+    float dzdx = (AMPLITUDE / flagWidth) * sin(phase) + amp * WAVE_NUMBER * cos(phase);
+    float dzdy = amp * VERTICAL_SKEW * cos(phase);
+    vec3 localNormal = normalize(vec3(-dzdx, -dzdy, 1.0));
+
+    // Cloth gets pulled slightly towards the pole where it bends most
+    vec3 localPos = vec3(aPos.x - 0.05 * s * abs(sin(phase)), aPos.y + flagRaise, z);
+
+    FragPos = vec3(model * vec4(localPos, 1.0));
+    Normal = mat3(transpose(inverse(model))) * localNormal;
+    TexCoords = aTexCoords;
+
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
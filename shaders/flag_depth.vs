@@ -0,0 +1,23 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+uniform mat4 lightSpaceMatrix;
+uniform mat4 model;
+
+uniform float waveTime;
+uniform float flagRaise;
+uniform float flagWidth;
+
+// Must match flag.vs so the shadow follows the waving cloth
+const float AMPLITUDE = 0.22;
+const float WAVE_NUMBER = 2.6;
+const float VERTICAL_SKEW = 0.7;
+
+void main()
+{
+    float s = aPos.x / flagWidth;
+    float phase = WAVE_NUMBER * aPos.x + VERTICAL_SKEW * aPos.y - waveTime * 2.0;
+    vec3 localPos = vec3(aPos.x - 0.05 * s * abs(sin(phase)), aPos.y + flagRaise, AMPLITUDE * s * sin(phase));
+
+    gl_Position = lightSpaceMatrix * model * vec4(localPos, 1.0);
+}
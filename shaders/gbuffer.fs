@@ -0,0 +1,57 @@
+#version 330 core
+// Geometry pass of the deferred renderer: surface attributes only, lighting
+// is applied afterwards in screen space (deferred_sun.fs, deferred_point.fs)
+layout (location = 0) out vec4 gAlbedo;   // rgb tinted albedo
+layout (location = 1) out vec4 gNormal;   // xyz world normal, w shininess
+layout (location = 2) out vec4 gEmissive; // rgb self-lit colour
+
+// Variants (same flag names as lighting_v4.fs; NIGHT_LIGHTS has no effect
+// here because lights are not evaluated in this pass):
+//   BUILDING_WINDOWS  - emissive lit windows (night buildings)
+//   BULB_GLOW         - emissive street light bulbs
+//   LUMINANCE_ALPHA   - alpha from texture brightness instead of texture alpha
+
+#include "emissive.glsl"
+#include "material.glsl"
+
+struct Material {
+    sampler2D diffuse;
+    sampler2D specular;
+    float shininess;
+}; 
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoords;
+
+uniform Material material;
+uniform float time;   // For window light variation
+uniform vec3 objectColor = vec3(1.0); // Tint color (default white)
+
+void main()
+{
+    vec4 texel = SampleDiffuse(material.diffuse, TexCoords);
+
+#ifdef LUMINANCE_ALPHA
+    float alpha = smoothstep(0.1, 0.6, dot(texel.rgb, vec3(0.299, 0.587, 0.114)));
+#else
+    float alpha = texel.a;
+#endif
+    // No blending into the G-buffer: cut out what the forward path blends away
+    if (alpha < 0.5)
+        discard;
+
+    vec3 emissive = vec3(0.0);
+#ifdef BUILDING_WINDOWS
+    emissive += WindowEmission(TexCoords, time);
+#endif
+#ifdef BULB_GLOW
+    emissive += objectColor * 3.5;
+#endif
+
+    // The forward path tints the lit result; tinting albedo and emission
+    // here gives the same colour since lighting is linear in albedo
+    gAlbedo = vec4(texel.rgb * objectColor, 1.0);
+    gNormal = vec4(normalize(Normal), material.shininess);
+    gEmissive = vec4(emissive * objectColor, 1.0);
+}
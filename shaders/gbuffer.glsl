@@ -0,0 +1,34 @@
+// gbuffer.glsl - G-buffer lookup for the deferred lighting passes
+// (pulled in with #include by the Shader class, so no version line here)
+
+uniform sampler2D gbufferAlbedo;
+uniform sampler2D gbufferNormal;
+uniform sampler2D gbufferEmissive;
+uniform sampler2D gbufferDepth;
+uniform mat4 inverseViewProjection;
+
+struct GSample {
+    vec3 position;  // World space, rebuilt from depth
+    vec3 normal;
+    vec3 albedo;
+    vec3 emissive;
+    float shininess;
+};
+
+// False where nothing was drawn (sky)
+bool ReadGBuffer(vec2 uv, out GSample g)
+{
+    float depth = texture(gbufferDepth, uv).r;
+    if (depth >= 1.0)
+        return false;
+
+    vec4 world = inverseViewProjection * vec4(vec3(uv, depth) * 2.0 - 1.0, 1.0);
+    g.position = world.xyz / world.w;
+
+    vec4 normal = texture(gbufferNormal, uv);
+    g.normal = normalize(normal.xyz);
+    g.shininess = normal.w;
+    g.albedo = texture(gbufferAlbedo, uv).rgb;
+    g.emissive = texture(gbufferEmissive, uv).rgb;
+    return true;
+}
@@ -0,0 +1,170 @@
+// lights.glsl - light types and Blinn-Phong terms shared by the lighting shaders
+// (pulled in with #include by the Shader class, so no version line here)
+
+struct DirLight {
+    vec3 direction;
+	
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+struct PointLight {
+    vec3 position;
+    float radius;   // Contribution fades to zero here (cluster bounds)
+    
+    float constant;
+    float linear;
+    float quadratic;
+	
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+struct SpotLight {
+    vec3 position;
+    vec3 direction;
+    float cutOff;
+    float outerCutOff;
+  
+    float constant;
+    float linear;
+    float quadratic;
+  
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;       
+};
+
+// Clustered point lights (see core/LightClusters): TILES_X x TILES_Y screen
+// tiles times SLICES exponential depth slices
+#define CLUSTER_TILES_X 16
+#define CLUSTER_TILES_Y 9
+#define CLUSTER_SLICES 24
+
+uniform usamplerBuffer clusterCells;        // offset, count per cluster
+uniform usamplerBuffer clusterLightIndices;
+uniform samplerBuffer clusterLights;        // 4 texels per light
+uniform vec2 clusterViewport;
+uniform float clusterSliceNear;
+uniform float clusterSliceFar;
+uniform float cameraNear;
+uniform float cameraFar;
+
+// Cluster of the current fragment (must match LightClusters::bin)
+int ClusterIndex()
+{
+    ivec2 tile = ivec2(gl_FragCoord.xy / clusterViewport * vec2(CLUSTER_TILES_X, CLUSTER_TILES_Y));
+    tile = clamp(tile, ivec2(0), ivec2(CLUSTER_TILES_X - 1, CLUSTER_TILES_Y - 1));
+
+    // Linear view depth from the [0,1] window depth
+    float ndcZ = gl_FragCoord.z * 2.0 - 1.0;
+    float depth = 2.0 * cameraNear * cameraFar / (cameraFar + cameraNear - ndcZ * (cameraFar - cameraNear));
+
+    int slice = 0;
+    if (depth > clusterSliceNear)
+        slice = int(log(depth / clusterSliceNear) / log(clusterSliceFar / clusterSliceNear) * float(CLUSTER_SLICES));
+    slice = min(slice, CLUSTER_SLICES - 1);
+
+    return (slice * CLUSTER_TILES_Y + tile.y) * CLUSTER_TILES_X + tile.x;
+}
+
+PointLight FetchPointLight(int index)
+{
+    vec4 t0 = texelFetch(clusterLights, index * 4);
+    vec4 t1 = texelFetch(clusterLights, index * 4 + 1);
+    vec4 t2 = texelFetch(clusterLights, index * 4 + 2);
+    vec4 t3 = texelFetch(clusterLights, index * 4 + 3);
+
+    PointLight light;
+    light.position = t0.xyz;
+    light.radius = t0.w;
+    light.ambient = t1.xyz;
+    light.constant = t1.w;
+    light.diffuse = t2.xyz;
+    light.linear = t2.w;
+    light.specular = t3.xyz;
+    light.quadratic = t3.w;
+    return light;
+}
+
+// Calculates the color when using a directional light.
+vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir, float shadow, vec3 albedo, float shininess)
+{
+    vec3 lightDir = normalize(-light.direction);
+    // Diffuse shading
+    float diff = max(dot(normal, lightDir), 0.0);
+    // Specular shading (Blinn-Phong)
+    vec3 halfwayDir = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(normal, halfwayDir), 0.0), shininess);
+    // Combine results
+    vec3 ambient = light.ambient * albedo;
+    vec3 diffuse = light.diffuse * diff * albedo;
+    vec3 specular = light.specular * spec * albedo;
+    
+    return (ambient + (1.0 - shadow) * (diffuse + specular));
+}
+
+// Calculates the color when using a point light.
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 albedo, float shininess)
+{
+    vec3 lightDir = normalize(light.position - fragPos);
+    // Diffuse shading
+    float diff = max(dot(normal, lightDir), 0.0);
+    // Specular shading
+    vec3 halfwayDir = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(normal, halfwayDir), 0.0), shininess);
+    // Attenuation
+    float distance = length(light.position - fragPos);
+    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));    
+    // Fade out over the last quarter of the radius so cluster edges never show
+    attenuation *= 1.0 - smoothstep(light.radius * 0.75, light.radius, distance);
+    // Combine results
+    vec3 ambient = light.ambient * albedo;
+    vec3 diffuse = light.diffuse * diff * albedo;
+    vec3 specular = light.specular * spec * albedo;
+    ambient *= attenuation;
+    diffuse *= attenuation;
+    specular *= attenuation;
+    return (ambient + diffuse + specular);
+}
+
+// Calculates the color when using a spot light.
+vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 albedo, float shininess)
+{
+    vec3 lightDir = normalize(light.position - fragPos);
+    // Diffuse shading
+    float diff = max(dot(normal, lightDir), 0.0);
+    // Specular shading
+    vec3 halfwayDir = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(normal, halfwayDir), 0.0), shininess);
+    // Attenuation
+    float distance = length(light.position - fragPos);
+    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));    
+    // Spotlight intensity
+    float theta = dot(lightDir, normalize(-light.direction)); 
+    float epsilon = light.cutOff - light.outerCutOff;
+    float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
+    // Combine results
+    vec3 ambient = light.ambient * albedo;
+    vec3 diffuse = light.diffuse * diff * albedo;
+    vec3 specular = light.specular * spec * albedo;
+    ambient *= attenuation * intensity;
+    diffuse *= attenuation * intensity;
+    specular *= attenuation * intensity;
+    return (ambient + diffuse + specular);
+}
+
+// Point lights of this fragment's cluster only (no shadow mapping)
+vec3 CalcClusteredPointLights(vec3 normal, vec3 fragPos, vec3 viewDir, vec3 albedo, float shininess)
+{
+    vec3 result = vec3(0.0);
+    uvec2 cell = texelFetch(clusterCells, ClusterIndex()).rg;
+    for(uint i = 0u; i < cell.y; i++)
+    {
+        int lightIndex = int(texelFetch(clusterLightIndices, int(cell.x + i)).r);
+        result += CalcPointLight(FetchPointLight(lightIndex), normal, fragPos, viewDir, albedo, shininess);
+    }
+    return result;
+}
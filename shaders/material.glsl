@@ -0,0 +1,12 @@
+// Diffuse lookup shared by the scene programs. Small and solid-colour
+// materials are layers of one array texture (TextureArray) picked per draw
+// with materialLayer; -1 samples the bound 2D texture instead
+uniform sampler2DArray materialLayers;
+uniform int materialLayer = -1;
+
+vec4 SampleDiffuse(sampler2D diffuse, vec2 uv)
+{
+    if (materialLayer >= 0)
+        return texture(materialLayers, vec3(uv, float(materialLayer)));
+    return texture(diffuse, uv);
+}
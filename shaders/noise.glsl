@@ -0,0 +1,53 @@
+// Improved Perlin noise and FBM for procedural textures: the same lattice,
+// gradients and fade curve as PerlinNoise (core/Noise.h), read from its
+// permutation table (256 x 1, bound by ProceduralTexture)
+uniform usampler2D noisePermutation;
+
+int NoisePerm(int i)
+{
+    return int(texelFetch(noisePermutation, ivec2(i & 255, 0), 0).r);
+}
+
+float NoiseFade(float t)
+{
+    return t * t * t * (t * (t * 6.0 - 15.0) + 10.0);
+}
+
+float NoiseGrad(int hash, vec3 p)
+{
+    int h = hash & 15;
+    float u = h < 8 ? p.x : p.y;
+    float v = h < 4 ? p.y : (h == 12 || h == 14 ? p.x : p.z);
+    return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v);
+}
+
+// -1..1
+float Noise(vec3 p)
+{
+    vec3 cell = floor(p);
+    int X = int(cell.x) & 255, Y = int(cell.y) & 255, Z = int(cell.z) & 255;
+    p -= cell;
+    vec3 f = vec3(NoiseFade(p.x), NoiseFade(p.y), NoiseFade(p.z));
+
+    int A = NoisePerm(X) + Y, AA = NoisePerm(A) + Z, AB = NoisePerm(A + 1) + Z;
+    int B = NoisePerm(X + 1) + Y, BA = NoisePerm(B) + Z, BB = NoisePerm(B + 1) + Z;
+    return mix(mix(mix(NoiseGrad(NoisePerm(AA), p), NoiseGrad(NoisePerm(BA), p - vec3(1, 0, 0)), f.x),
+                   mix(NoiseGrad(NoisePerm(AB), p - vec3(0, 1, 0)), NoiseGrad(NoisePerm(BB), p - vec3(1, 1, 0)), f.x), f.y),
+               mix(mix(NoiseGrad(NoisePerm(AA + 1), p - vec3(0, 0, 1)), NoiseGrad(NoisePerm(BA + 1), p - vec3(1, 0, 1)), f.x),
+                   mix(NoiseGrad(NoisePerm(AB + 1), p - vec3(0, 1, 1)), NoiseGrad(NoisePerm(BB + 1), p - vec3(1, 1, 1)), f.x), f.y),
+               f.z);
+}
+
+// Octaves at doubling frequency and halving amplitude, normalised to -1..1
+float Fbm(vec3 p, int octaves)
+{
+    float total = 0.0, amplitude = 1.0, maxValue = 0.0;
+    for (int i = 0; i < octaves; i++)
+    {
+        total += Noise(p) * amplitude;
+        maxValue += amplitude;
+        amplitude *= 0.5;
+        p *= 2.0;
+    }
+    return total / maxValue;
+}
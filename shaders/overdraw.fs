@@ -0,0 +1,10 @@
+#version 330 core
+out vec4 FragColor;
+
+// Overdraw view: every shaded fragment adds one step (additive blending),
+// so brightness counts how often a pixel ran the lighting shader
+
+void main()
+{
+    FragColor = vec4(0.08, 0.04, 0.02, 1.0);
+}
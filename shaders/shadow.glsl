@@ -0,0 +1,79 @@
+// shadow.glsl - cascaded sun shadow lookup shared by the forward and deferred shaders
+// (pulled in with #include by the Shader class, so no version line here)
+
+// Quality variants (default: 4 bilinear taps covering a 3x3 texel footprint):
+//   SHADOW_TAPS_1      - one bilinear tap (2x2 footprint)
+//   SHADOW_POISSON_16  - 16 taps on a Poisson disk (softest)
+
+// Must match ShadowCascades::COUNT
+#define SHADOW_CASCADES 4
+
+uniform sampler2DArrayShadow shadowMap;         // One depth layer per cascade, hardware compare
+uniform mat4 cascadeMatrices[SHADOW_CASCADES];  // World to light clip space
+uniform float cascadeSplits[SHADOW_CASCADES];   // Far view depth of each cascade
+uniform float cascadeBias[SHADOW_CASCADES];     // Depth bias in each cascade's units
+uniform mat4 view;
+
+#ifdef SHADOW_POISSON_16
+const vec2 POISSON_DISK[16] = vec2[](
+    vec2(-0.94201624, -0.39906216), vec2(0.94558609, -0.76890725),
+    vec2(-0.09418410, -0.92938870), vec2(0.34495938, 0.29387760),
+    vec2(-0.91588581, 0.45771432), vec2(-0.81544232, -0.87912464),
+    vec2(-0.38277543, 0.27676845), vec2(0.97484398, 0.75648379),
+    vec2(0.44323325, -0.97511554), vec2(0.53742981, -0.47373420),
+    vec2(-0.26496911, -0.41893023), vec2(0.79197514, 0.19090188),
+    vec2(-0.24188840, 0.99706507), vec2(-0.81409955, 0.91437590),
+    vec2(0.19984126, 0.78641367), vec2(0.14383161, -0.14100790)
+);
+#endif
+
+// Shadow Calculation: 0 lit, 1 fully shadowed
+float ShadowCalculation(vec3 fragPos, vec3 normal, vec3 lightDir)
+{
+    // Nearest cascade whose slice contains the fragment
+    float viewDepth = -(view * vec4(fragPos, 1.0)).z;
+    int cascade = 0;
+    while (cascade < SHADOW_CASCADES && viewDepth > cascadeSplits[cascade])
+        cascade++;
+    // Beyond the shadow distance
+    if (cascade == SHADOW_CASCADES)
+        return 0.0;
+
+    vec4 fragPosLightSpace = cascadeMatrices[cascade] * vec4(fragPos, 1.0);
+    // perform perspective divide
+    vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
+    // transform to [0,1] range
+    projCoords = projCoords * 0.5 + 0.5;
+    // get depth of current fragment from light's perspective
+    float currentDepth = projCoords.z;
+    // Keep the shadow at 0.0 when outside the far_plane region of the light's frustum.
+    if (currentDepth > 1.0)
+        return 0.0;
+
+    // Steeper surfaces need more bias
+    float bias = cascadeBias[cascade] * max(3.0 * (1.0 - dot(normal, lightDir)), 1.0);
+    
+    // PCF in hardware: each tap compares 4 texels and filters the results
+    vec2 texelSize = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+    float layer = float(cascade);
+    float reference = currentDepth - bias;
+    float lit = 0.0;
+#if defined(SHADOW_TAPS_1)
+    lit = texture(shadowMap, vec4(projCoords.xy, layer, reference));
+#elif defined(SHADOW_POISSON_16)
+    for (int i = 0; i < 16; i++)
+        lit += texture(shadowMap, vec4(projCoords.xy + POISSON_DISK[i] * 1.5 * texelSize, layer, reference));
+    lit /= 16.0;
+#else
+    for (int x = 0; x < 2; x++)
+    {
+        for (int y = 0; y < 2; y++)
+        {
+            vec2 offset = vec2(float(x) - 0.5, float(y) - 0.5) * texelSize;
+            lit += texture(shadowMap, vec4(projCoords.xy + offset, layer, reference));
+        }
+    }
+    lit /= 4.0;
+#endif
+    return 1.0 - lit;
+}
@@ -5,10 +5,12 @@ out vec3 LocalPos;
 
 uniform mat4 projection;
 uniform mat4 view;
-uniform mat4 model;
 
 void main()
 {
     LocalPos = aPos;
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    // Rotation only, so the dome stays centred on the camera; z = w puts
+    // every vertex on the far plane (depth 1.0), behind all geometry
+    vec4 pos = projection * mat4(mat3(view)) * vec4(aPos, 1.0);
+    gl_Position = pos.xyww;
 }
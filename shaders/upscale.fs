@@ -0,0 +1,31 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D sceneColor; // Render resolution, linear filtered
+uniform vec2 sourceSize;      // Render resolution in pixels
+uniform float sharpness;      // 0 = plain bilinear
+
+// Bilinear upscale plus a contrast-adaptive sharpen: the four neighbours one
+// source pixel away are subtracted, less where the neighbourhood already
+// spans a wide range, and the result is clamped to that range so edges do
+// not ring
+void main()
+{
+    vec2 texel = 1.0 / sourceSize;
+    vec3 c = texture(sceneColor, TexCoords).rgb;
+    vec3 n = texture(sceneColor, TexCoords + vec2(0.0, texel.y)).rgb;
+    vec3 s = texture(sceneColor, TexCoords - vec2(0.0, texel.y)).rgb;
+    vec3 e = texture(sceneColor, TexCoords + vec2(texel.x, 0.0)).rgb;
+    vec3 w = texture(sceneColor, TexCoords - vec2(texel.x, 0.0)).rgb;
+
+    vec3 lo = min(c, min(min(n, s), min(e, w)));
+    vec3 hi = max(c, max(max(n, s), max(e, w)));
+
+    // Headroom to black or white relative to the brightest neighbour
+    vec3 amount = sqrt(clamp(min(lo, 1.0 - hi) / max(hi, vec3(1e-4)), 0.0, 1.0)) * sharpness;
+    vec3 sharpened = c + (4.0 * c - n - s - e - w) * amount * 0.25;
+
+    FragColor = vec4(clamp(sharpened, lo, hi), 1.0);
+}